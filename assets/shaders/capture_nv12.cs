@@ -0,0 +1,72 @@
+#version 430 core
+// RGBA -> NV12 (BT.709, limited range). One invocation converts a 4x2 pixel block: two words of luma and
+// one word of interleaved chroma. Width must be a multiple of 4 and height a multiple of 2.
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform sampler2D u_source;
+
+layout(std430, binding = 0) writeonly buffer nv12_output
+{
+    uint data[];
+};
+
+uniform int  u_width;
+uniform int  u_height;
+uniform bool u_flip; // GL images start at the bottom row, video frames at the top
+
+vec3 fetch(ivec2 p)
+{
+    if (u_flip)
+    {
+        p.y = u_height - 1 - p.y;
+    }
+    return texelFetch(u_source, p, 0).rgb;
+}
+
+float luma(vec3 c)
+{
+    return 16.0 + dot(c, vec3(0.2126, 0.7152, 0.0722)) * 219.0;
+}
+
+vec2 chroma(vec3 c)
+{
+    return vec2(128.0 + dot(c, vec3(-0.1146, -0.3854, 0.5)) * 224.0,
+                128.0 + dot(c, vec3(0.5, -0.4542, -0.0458)) * 224.0);
+}
+
+uint pack4(vec4 v)
+{
+    uvec4 u = uvec4(clamp(round(v), 0.0, 255.0));
+    return u.x | (u.y << 8) | (u.z << 16) | (u.w << 24);
+}
+
+void main()
+{
+    ivec2 block  = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 origin = block * ivec2(4, 2);
+    if (origin.x >= u_width || origin.y >= u_height)
+    {
+        return;
+    }
+
+    vec3 c[2][4];
+    for (int row = 0; row < 2; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            c[row][col] = fetch(origin + ivec2(col, row));
+        }
+    }
+
+    uint row_words = uint(u_width) / 4u;
+    for (int row = 0; row < 2; ++row)
+    {
+        data[uint(origin.y + row) * row_words + uint(block.x)] =
+            pack4(vec4(luma(c[row][0]), luma(c[row][1]), luma(c[row][2]), luma(c[row][3])));
+    }
+
+    vec3 left  = (c[0][0] + c[0][1] + c[1][0] + c[1][1]) * 0.25;
+    vec3 right = (c[0][2] + c[0][3] + c[1][2] + c[1][3]) * 0.25;
+    uint luma_words = row_words * uint(u_height);
+    data[luma_words + uint(block.y) * row_words + uint(block.x)] = pack4(vec4(chroma(left), chroma(right)));
+}
@@ -0,0 +1,89 @@
+#version 430 core
+// One work group per cluster. Each invocation tests a strided subset of the lights against the cluster's AABB and
+// appends hits to a shared list, which is then copied out to a range reserved with one global atomic.
+layout(local_size_x = 64) in;
+
+// Injected by clustered_lighting from cluster_settings::max_lights_per_cluster
+#ifndef MAX_LIGHTS_PER_CLUSTER
+#define MAX_LIGHTS_PER_CLUSTER 256
+#endif
+
+#include "light_data.glsl"
+
+layout(std430, binding = 3) readonly buffer cluster_lights
+{
+    light_data lights[];
+};
+
+layout(std430, binding = 4) writeonly buffer cluster_grid
+{
+    uvec2 grid[];
+};
+
+layout(std430, binding = 5) writeonly buffer cluster_indices
+{
+    uint light_indices[];
+};
+
+layout(std430, binding = 6) readonly buffer cluster_bounds
+{
+    vec4 bounds[]; // min, max per cluster
+};
+
+layout(std430, binding = 7) buffer cluster_counter
+{
+    uint index_count;
+};
+
+uniform int u_light_count;
+uniform int u_max_per_cluster;
+uniform int u_max_indices;
+
+shared uint s_count;
+shared uint s_offset;
+shared uint s_lights[MAX_LIGHTS_PER_CLUSTER];
+
+void main()
+{
+    uint cluster = gl_WorkGroupID.x;
+    if (gl_LocalInvocationIndex == 0)
+    {
+        s_count = 0;
+    }
+    barrier();
+
+    vec3 box_min  = bounds[cluster * 2].xyz;
+    vec3 box_max  = bounds[cluster * 2 + 1].xyz;
+    uint capacity = min(uint(u_max_per_cluster), MAX_LIGHTS_PER_CLUSTER);
+    for (uint i = gl_LocalInvocationIndex; i < uint(u_light_count); i += gl_WorkGroupSize.x)
+    {
+        vec4 sphere = lights[i].position_radius;
+        vec3 d      = clamp(sphere.xyz, box_min, box_max) - sphere.xyz;
+        if (dot(d, d) <= sphere.w * sphere.w)
+        {
+            uint slot = atomicAdd(s_count, 1);
+            if (slot < capacity)
+            {
+                s_lights[slot] = i;
+            }
+        }
+    }
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        uint count = min(s_count, capacity);
+        uint start = atomicAdd(index_count, count);
+        uint limit = uint(u_max_indices);
+        count      = start >= limit ? 0 : min(count, limit - start);
+        grid[cluster] = uvec2(start, count);
+        s_offset      = start;
+        s_count       = count;
+    }
+    barrier();
+
+    for (uint i = gl_LocalInvocationIndex; i < s_count; i += gl_WorkGroupSize.x)
+    {
+        light_indices[s_offset + i] = s_lights[i];
+    }
+}
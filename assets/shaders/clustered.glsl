@@ -0,0 +1,66 @@
+// Clustered forward lighting for fragment shaders, the buffers and uniforms are bound by clustered_lighting::bind().
+// clustered_lighting() sums every light in the fragment's cluster
+#include "light_data.glsl"
+
+layout(std430, binding = 3) readonly buffer cluster_lights
+{
+    light_data lights[];
+};
+
+layout(std430, binding = 4) readonly buffer cluster_grid
+{
+    uvec2 grid[];
+};
+
+layout(std430, binding = 5) readonly buffer cluster_indices
+{
+    uint light_indices[];
+};
+
+uniform int   u_cluster_tiles_x;
+uniform int   u_cluster_tiles_y;
+uniform int   u_cluster_slices;
+uniform float u_cluster_z_scale;
+uniform float u_cluster_z_bias;
+uniform float u_cluster_tile_width;
+uniform float u_cluster_tile_height;
+
+uint cluster_index(vec2 frag_xy, float view_depth)
+{
+    int slice = clamp(int(log(view_depth) * u_cluster_z_scale + u_cluster_z_bias), 0, u_cluster_slices - 1);
+    int x     = clamp(int(frag_xy.x / u_cluster_tile_width), 0, u_cluster_tiles_x - 1);
+    int y     = clamp(int(frag_xy.y / u_cluster_tile_height), 0, u_cluster_tiles_y - 1);
+    return uint((slice * u_cluster_tiles_y + y) * u_cluster_tiles_x + x);
+}
+
+vec3 shade_light(light_data l, vec3 position, vec3 normal)
+{
+    vec3  to_light = l.position_radius.xyz - position;
+    float dist     = length(to_light);
+    float radius   = l.position_radius.w;
+    if (dist >= radius)
+    {
+        return vec3(0.0);
+    }
+
+    vec3  dir         = to_light / dist;
+    float falloff     = 1.0 - dist / radius;
+    float attenuation = falloff * falloff;
+    if (l.direction_cos.w > -1.0)
+    {
+        float cos_angle = dot(-dir, l.direction_cos.xyz);
+        attenuation *= smoothstep(l.direction_cos.w, mix(l.direction_cos.w, 1.0, 0.1), cos_angle);
+    }
+    return l.color_intensity.rgb * l.color_intensity.w * attenuation * max(dot(normal, dir), 0.0);
+}
+
+vec3 clustered_lighting(vec2 frag_xy, vec3 position, vec3 normal)
+{
+    uvec2 cell  = grid[cluster_index(frag_xy, -position.z)];
+    vec3  color = vec3(0.0);
+    for (uint i = 0; i < cell.y; ++i)
+    {
+        color += shade_light(lights[light_indices[cell.x + i]], position, normal);
+    }
+    return color;
+}
@@ -0,0 +1,33 @@
+#version 430 core
+// Ground plane lit through the light clusters, used by light_bench
+
+#include "clustered.glsl"
+
+uniform float u_tan_half_fov_x;
+uniform float u_tan_half_fov_y;
+uniform float u_far;
+uniform float u_ground_height;
+
+in vec2 v_uv;
+out vec4 frag_color;
+
+void main()
+{
+    vec2 ndc = v_uv * 2.0 - 1.0;
+    vec3 ray = normalize(vec3(ndc.x * u_tan_half_fov_x, ndc.y * u_tan_half_fov_y, -1.0));
+    if (ray.y >= 0.0)
+    {
+        frag_color = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    vec3 position = ray * (u_ground_height / ray.y);
+    if (-position.z > u_far)
+    {
+        frag_color = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    vec3 lit   = clustered_lighting(gl_FragCoord.xy, position, vec3(0.0, 1.0, 0.0));
+    frag_color = vec4(lit / (lit + 1.0), 1.0);
+}
@@ -0,0 +1,7 @@
+// Matches gfx::light, shared by the cluster assignment and the shading side
+struct light_data
+{
+    vec4 position_radius;
+    vec4 color_intensity;
+    vec4 direction_cos;
+};
@@ -0,0 +1,45 @@
+// Particle state shared by the particle_*.cs passes and particle_render.vs, see particle_system for the bindings.
+// Only the blocks a stage actually reads count against its storage block limit
+struct particle
+{
+    vec4 position_age;  // w: seconds since spawn
+    vec4 velocity_life; // w: lifetime in seconds
+    vec4 color;
+};
+
+layout(std430, binding = 8) buffer particle_counters
+{
+    uint dead_count;
+    uint alive_count[2];
+    uint emit_count;
+    uint requested;
+};
+
+layout(std430, binding = 9) buffer particle_data
+{
+    particle particles[];
+};
+
+layout(std430, binding = 10) buffer particle_dead_list
+{
+    uint dead_list[];
+};
+
+layout(std430, binding = 11) buffer particle_alive_current
+{
+    uint alive_current[];
+};
+
+layout(std430, binding = 12) buffer particle_alive_next
+{
+    uint alive_next[];
+};
+
+layout(std430, binding = 13) buffer particle_indirect
+{
+    uvec3 emit_dispatch;
+    uvec3 simulate_dispatch;
+    uvec4 draw; // count, instance count, first, base instance
+};
+
+uniform int u_current; // which alive_count belongs to alive_current
@@ -0,0 +1,51 @@
+#version 430 core
+layout(local_size_x = 64) in;
+
+#include "particle_common.glsl"
+
+uniform vec3  u_position;
+uniform vec3  u_velocity;
+uniform vec4  u_color;
+uniform float u_spread;
+uniform float u_lifetime;
+uniform float u_lifetime_jitter;
+uniform int   u_seed;
+
+uint hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(inout uint state)
+{
+    state = hash(state);
+    return float(state) / 4294967295.0;
+}
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= emit_count)
+    {
+        return;
+    }
+
+    // kickoff clamped emit_count to dead_count, so this can't underflow
+    uint index = dead_list[atomicAdd(dead_count, 0xffffffffu) - 1u];
+
+    uint state  = hash(id ^ (uint(u_seed) * 0x9e3779b9u));
+    vec3 jitter = vec3(random(state), random(state), random(state)) * 2.0 - 1.0;
+
+    particle p;
+    p.position_age  = vec4(u_position, 0.0);
+    p.velocity_life = vec4(u_velocity + jitter * u_spread, u_lifetime + (random(state) * 2.0 - 1.0) * u_lifetime_jitter);
+    p.color         = u_color;
+    particles[index] = p;
+
+    alive_current[atomicAdd(alive_count[u_current], 1u)] = index;
+}
@@ -0,0 +1,10 @@
+#version 430 core
+// Single invocation. Sizes the indirect draw from the survivors of this frame's simulation.
+layout(local_size_x = 1) in;
+
+#include "particle_common.glsl"
+
+void main()
+{
+    draw = uvec4(4u, alive_count[1 - u_current], 0u, 0u);
+}
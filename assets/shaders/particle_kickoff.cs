@@ -0,0 +1,14 @@
+#version 430 core
+// Single invocation. Clamps the emission request to the free slots and sizes the emit and simulate dispatches, so
+// the CPU never needs to know how many particles are alive.
+layout(local_size_x = 1) in;
+
+#include "particle_common.glsl"
+
+void main()
+{
+    emit_count                 = min(requested, dead_count);
+    emit_dispatch              = uvec3((emit_count + 63u) / 64u, 1u, 1u);
+    simulate_dispatch          = uvec3((alive_count[u_current] + emit_count + 63u) / 64u, 1u, 1u);
+    alive_count[1 - u_current] = 0u;
+}
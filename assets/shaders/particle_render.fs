@@ -0,0 +1,11 @@
+#version 430 core
+
+in vec4 v_color;
+in vec2 v_corner;
+out vec4 frag_color;
+
+void main()
+{
+    float falloff = max(1.0 - dot(v_corner, v_corner), 0.0);
+    frag_color    = vec4(v_color.rgb, v_color.a * falloff);
+}
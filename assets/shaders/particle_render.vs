@@ -0,0 +1,22 @@
+#version 430 core
+// One instanced quad per alive particle, expanded in clip space so it always faces the camera
+
+#include "particle_common.glsl"
+#include "uniform_blocks.glsl"
+
+uniform float u_size;
+
+out vec4 v_color;
+out vec2 v_corner;
+
+void main()
+{
+    particle p      = particles[alive_next[gl_InstanceID]];
+    vec2     corner = vec2(gl_VertexID & 1, (gl_VertexID >> 1) & 1) * 2.0 - 1.0;
+
+    float fade  = 1.0 - p.position_age.w / p.velocity_life.w;
+    v_color     = vec4(p.color.rgb, p.color.a * fade);
+    v_corner    = corner;
+    gl_Position = u_view_projection * vec4(p.position_age.xyz, 1.0);
+    gl_Position.xy += corner * u_size * vec2(u_viewport.y * u_viewport.z, 1.0); // height / width
+}
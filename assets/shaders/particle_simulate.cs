@@ -0,0 +1,32 @@
+#version 430 core
+// Ages and integrates every alive particle. Survivors are compacted into alive_next, the rest go back on the dead list.
+layout(local_size_x = 64) in;
+
+#include "particle_common.glsl"
+
+uniform float u_dt;
+uniform vec3  u_gravity;
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= alive_count[u_current])
+    {
+        return;
+    }
+
+    uint     index = alive_current[id];
+    particle p     = particles[index];
+    p.position_age.w += u_dt;
+    if (p.position_age.w >= p.velocity_life.w)
+    {
+        dead_list[atomicAdd(dead_count, 1u)] = index;
+        return;
+    }
+
+    p.velocity_life.xyz += u_gravity * u_dt;
+    p.position_age.xyz += p.velocity_life.xyz * u_dt;
+    particles[index] = p;
+
+    alive_next[atomicAdd(alive_count[1 - u_current], 1u)] = index;
+}
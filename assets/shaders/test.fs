@@ -1,12 +1,10 @@
 #version 330 core
 
-uniform float red;
-uniform float green;
-uniform float blue;
+#include "uniform_blocks.glsl"
 
 out vec4 fragColor;
 
 void main()
 {
-    fragColor = vec4(red, green, blue, 1.0);
+    fragColor = u_base_color;
 }
\ No newline at end of file
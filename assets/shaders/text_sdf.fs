@@ -0,0 +1,22 @@
+#version 430 core
+// The atlas holds FreeType's distance fields, 0.5 is the outline. Screen space derivatives keep the edge about a
+// pixel wide whatever the text is scaled to
+
+in vec2 v_uv;
+in vec4 v_color;
+
+uniform sampler2D u_atlas;
+
+out vec4 frag_color;
+
+void main()
+{
+    float distance = texture(u_atlas, v_uv).r;
+    float width    = max(fwidth(distance), 1e-4);
+    float alpha    = smoothstep(0.5 - width, 0.5 + width, distance);
+    if (alpha <= 0.0)
+    {
+        discard;
+    }
+    frag_color = vec4(v_color.rgb, v_color.a * alpha);
+}
@@ -0,0 +1,21 @@
+#version 430 core
+// One instanced quad per glyph, see text_renderer::glyph_instance
+
+layout(location = 0) in vec4 a_rect; // x, y, width, height in pixels
+layout(location = 1) in vec4 a_uv;   // u0, v0, u1, v1
+layout(location = 2) in vec4 a_color;
+
+uniform vec4 u_screen; // pixels to clip space scale and offset
+
+out vec2 v_uv;
+out vec4 v_color;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, (gl_VertexID >> 1) & 1);
+    vec2 pixel  = a_rect.xy + corner * a_rect.zw;
+
+    v_uv        = mix(a_uv.xy, a_uv.zw, corner);
+    v_color     = a_color;
+    gl_Position = vec4(pixel * u_screen.xy + u_screen.zw, 0.0, 1.0);
+}
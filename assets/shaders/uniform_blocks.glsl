@@ -0,0 +1,34 @@
+// Engine uniform blocks, mirrored by the structs in UniformBlocks.h. Bindings are assigned after linking from
+// uniform_slot, member names and offsets are checked against the C++ side at the same time
+
+layout(std140) uniform frame_data
+{
+    float u_time;
+    float u_delta_time;
+    uint  u_frame_index;
+    vec4  u_resolution; // width, height, 1 / width, 1 / height
+};
+
+layout(std140) uniform view_data
+{
+    mat4 u_view;
+    mat4 u_projection;
+    mat4 u_view_projection;
+    vec4 u_camera_position;
+    vec4 u_viewport;
+};
+
+layout(std140) uniform material_data
+{
+    vec4  u_base_color;
+    float u_roughness;
+    float u_metallic;
+    float u_emissive;
+    float u_alpha_cutoff;
+};
+
+layout(std140) uniform object_data
+{
+    mat4 u_model;
+    mat4 u_normal_matrix;
+};
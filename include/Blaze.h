@@ -23,24 +23,36 @@
 #include <unordered_map>
 #include <functional>
 
-#include "Core/Window.h"
+#include "Core/WindowRegistry.h"
 #include "Core/Logger.h"
+#include "Core/FrameLoop.h"
+#include "Core/Input.h"
 
 namespace blaze
 {
-bool init();
+bool init(backend mode = backend::windowed);
 void shutdown();
 void run();
+// Ends run() after the current frame
+void quit();
 
-const std::unordered_map<std::string, uptr<window>>& windows();
+const window_registry& windows();
 
-bool create_window(const std::string& title, i32 width, i32 height);
-void destroy_window(const std::string& title);
+// Returns an invalid handle on failure
+window_handle create_window(const std::string& title, i32 width, i32 height);
+void          destroy_window(window_handle handle);
+void          destroy_window(hashed_id title);
+void          destroy_window(const std::string& title);
 
 void set_render_function(const std::function<void()>& render_function);
+// Called loop::current_settings().fixed_step apart in simulation time, with that step as the argument
+void set_update_function(const std::function<void(f64)>& update_function);
 
 namespace gfx
 {
+void activate_window(window_handle handle);
+// Prefer "Title"_id over the string overload in per frame code, it skips hashing the title
+void activate_window(hashed_id title);
 void activate_window(const std::string& title);
 } // namespace gfx
 } // namespace blaze
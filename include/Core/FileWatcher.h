@@ -0,0 +1,73 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_FILEWATCHER_H
+#define BLAZE_FILEWATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Types.h"
+
+namespace blaze
+{
+
+// Watches a directory tree for files being written on a background thread. Editors tend to produce several events per
+// save (truncate, write, rename), so a file is only reported once it has been quiet for the debounce period.
+// inotify backed, start() fails on other platforms
+class file_watcher
+{
+public:
+    file_watcher() = default;
+    ~file_watcher();
+    file_watcher(const file_watcher&)            = delete;
+    file_watcher& operator=(const file_watcher&) = delete;
+
+    bool start(const std::string& directory, u32 debounce_ms = 100);
+    void stop();
+
+    // Appends the settled changes, paths relative to the watched directory with '/' separators
+    bool changes(std::vector<std::string>& out);
+
+    bool watching() const { return m_thread.joinable(); }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    std::string                                        m_root{};
+    std::chrono::milliseconds                          m_debounce{};
+    std::thread                                        m_thread{};
+    std::atomic<bool>                                  m_running{ false };
+    std::mutex                                         m_mutex{};
+    std::unordered_map<std::string, clock::time_point> m_pending{};     // guarded by m_mutex
+    std::unordered_map<i32, std::string>               m_directories{}; // watch descriptor to relative path
+    i32                                                m_fd{ -1 };
+
+    void watch_tree(const std::string& relative);
+    void run();
+};
+
+} // namespace blaze
+
+#endif //BLAZE_FILEWATCHER_H
@@ -0,0 +1,74 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_FRAMELOOP_H
+#define BLAZE_FRAMELOOP_H
+
+#include "Types.h"
+
+namespace blaze::loop
+{
+
+enum class vsync_mode : u8
+{
+    off,
+    on,
+    adaptive, // late frames tear instead of waiting a full interval. Falls back to on if the driver can't do it
+};
+
+struct settings
+{
+    f64        fixed_step{ 1.0 / 60.0 }; // seconds per update tick
+    u32        max_steps{ 5 };           // update ticks allowed per frame before time is dropped, avoids the spiral of death
+    f64        target_fps{ 0.0 };        // frame limiter, 0 means uncapped
+    vsync_mode vsync{ vsync_mode::on };
+};
+
+struct stats
+{
+    f64 delta{};      // seconds between the start of the last two frames
+    f64 alpha{};      // how far render time is between the last update tick and the next one, [0, 1)
+    f64 average_ms{}; // over the sample window
+    f64 p50_ms{};
+    f64 p99_ms{};
+    u64 frame_count{};
+};
+
+void            configure(const settings& s);
+const settings& current_settings();
+const stats&    frame_stats();
+
+f64 delta_time();
+f64 alpha();
+
+namespace detail
+{
+// Without a swapchain (headless) vsync settings are ignored
+void start(bool swap_control);
+// Returns how many fixed updates should run this frame
+u32  begin_frame();
+// Runs the frame limiter and records the frame time
+void end_frame();
+// Swap interval the settings ask for, -1 for adaptive. Applied per window, see window::set_swap_interval
+i32  swap_interval();
+} // namespace detail
+
+} // namespace blaze::loop
+
+#endif //BLAZE_FRAMELOOP_H
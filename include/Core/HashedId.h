@@ -0,0 +1,120 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_HASHEDID_H
+#define BLAZE_HASHEDID_H
+
+#include <format>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+
+#include "Types.h"
+
+namespace blaze
+{
+
+namespace hash
+{
+constexpr u64 fnv_offset = 14695981039346656037ull;
+constexpr u64 fnv_prime  = 1099511628211ull;
+
+// 64 bit FNV-1a. Pass the previous result as the seed to hash several pieces as one
+constexpr u64 fnv1a(std::string_view bytes, u64 seed = fnv_offset)
+{
+    u64 hash = seed;
+    for (char c : bytes)
+    {
+        hash ^= (u8) c;
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+} // namespace hash
+
+// A name reduced to its 64 bit hash. Built from a literal with "name"_id the hash is done by the compiler, so looking
+// things up by id never touches the string at runtime
+class hashed_id
+{
+public:
+    constexpr hashed_id() = default;
+    constexpr explicit hashed_id(std::string_view name) : m_value{ hash::fnv1a(name) } {}
+
+    constexpr u64  value() const { return m_value; }
+    constexpr bool is_valid() const { return m_value != 0; }
+
+    constexpr bool operator==(const hashed_id&) const = default;
+    constexpr auto operator<=>(const hashed_id&) const = default;
+
+private:
+    u64 m_value{};
+};
+
+// Hashes the name and remembers it, for names only known at runtime (window titles, file names, reflected uniforms).
+// Two different names with the same hash are reported as an error. Thread safe
+hashed_id intern(std::string_view name);
+
+// The name an id was interned from, empty if it never was. Literals are only recorded in debug builds, so release
+// builds only know the interned ones
+std::string_view name_of(hashed_id id);
+
+inline namespace literals
+{
+#ifdef _DEBUG
+// Runtime uses go through the interner so logs can print the name, constant evaluated ones are still free
+constexpr hashed_id operator""_id(const char* name, size_t length)
+{
+    if (std::is_constant_evaluated())
+    {
+        return hashed_id{ std::string_view{ name, length } };
+    }
+    return intern(std::string_view{ name, length });
+}
+#else
+consteval hashed_id operator""_id(const char* name, size_t length)
+{
+    return hashed_id{ std::string_view{ name, length } };
+}
+#endif
+} // namespace literals
+
+} // namespace blaze
+
+template<>
+struct std::hash<blaze::hashed_id>
+{
+    size_t operator()(blaze::hashed_id id) const noexcept { return (size_t) id.value(); }
+};
+
+// Prints the name when it's known, the raw hash otherwise
+template<>
+struct std::formatter<blaze::hashed_id> : std::formatter<std::string_view>
+{
+    template<typename Context>
+    auto format(blaze::hashed_id id, Context& ctx) const
+    {
+        if (const std::string_view name = blaze::name_of(id); !name.empty())
+        {
+            return std::formatter<std::string_view>::format(name, ctx);
+        }
+        return std::format_to(ctx.out(), "#{:016x}", id.value());
+    }
+};
+
+#endif //BLAZE_HASHEDID_H
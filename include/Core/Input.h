@@ -0,0 +1,121 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_INPUT_H
+#define BLAZE_INPUT_H
+
+#include <array>
+#include <bitset>
+
+#include "Types.h"
+
+union SDL_Event;
+namespace blaze::input
+{
+
+constexpr u32 max_keys         = 512; // SDL_NUM_SCANCODES
+constexpr u32 max_gamepads     = 4;
+constexpr u32 max_gamepad_axes = 6;
+
+enum class event_type : u8
+{
+    key_down,
+    key_up,
+    mouse_move,
+    mouse_down,
+    mouse_up,
+    mouse_wheel,
+    gamepad_added,
+    gamepad_removed,
+    gamepad_down,
+    gamepad_up,
+    gamepad_axis,
+};
+
+struct event
+{
+    event_type type{};
+    u8         device{};    // gamepad slot
+    u16        code{};      // scancode, mouse button, gamepad button or gamepad axis
+    i32        x{};         // mouse position, wheel delta or axis value
+    i32        y{};
+    u32        window_id{}; // SDL window ID, 0 for gamepads
+    u64        timestamp{}; // SDL ticks in ms
+};
+
+struct gamepad_state
+{
+    bool                              connected{ false };
+    u32                               buttons{}; // bit per SDL_GameControllerButton
+    std::array<i16, max_gamepad_axes> axes{};
+
+    constexpr bool button(u32 b) const { return (buttons >> b) & 1u; }
+};
+
+// Immutable picture of all devices at the end of a frame's event pump
+struct state
+{
+    std::bitset<max_keys>                   keys{};
+    u32                                     mouse_buttons{}; // bit per SDL mouse button
+    i32                                     mouse_x{};
+    i32                                     mouse_y{};
+    i32                                     mouse_dx{}; // accumulated over the frame
+    i32                                     mouse_dy{};
+    i32                                     wheel_x{};
+    i32                                     wheel_y{};
+    std::array<gamepad_state, max_gamepads> gamepads{};
+    u64                                     frame{};
+    u64                                     timestamp{};
+
+    bool           key(u16 scancode) const { return scancode < max_keys && keys.test(scancode); }
+    constexpr bool mouse_button(u8 b) const { return (mouse_buttons >> b) & 1u; }
+};
+
+struct latency_stats
+{
+    f64 last_frame_max_ms{}; // oldest event of the last frame -> that frame being presented
+    f64 average_ms{};        // exponential moving average of the per frame value
+    u64 dropped_events{};    // events not queued because nobody drained the queue
+};
+
+// Pops the next event. Single consumer: call from one thread only. Events that arrive while the queue is full are
+// dropped, but are still reflected in the snapshot.
+bool poll(event& out);
+
+// Copy of the most recently published state. Safe from any thread, never takes a lock.
+state snapshot();
+
+// Copy of the latest figures, published once a frame like the snapshot
+latency_stats latency();
+
+namespace detail
+{
+bool init();
+void shutdown();
+
+void begin_frame();
+void process(const SDL_Event& e);
+// Publishes the snapshot
+void end_frame();
+void frame_presented();
+} // namespace detail
+
+} // namespace blaze::input
+
+#endif //BLAZE_INPUT_H
@@ -21,6 +21,9 @@
 #define BLAZE_LOGGER_H
 
 #include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
 
 #include "Types.h"
 
@@ -40,17 +43,28 @@ enum class log_level
 namespace detail
 {
 void output(log_level lvl, std::string_view msg);
+
+// Formats into a per thread buffer that keeps its capacity, so logging stops touching the heap once it's warmed up.
+// The view is valid until the thread's next call
+template<typename... Args>
+std::string_view format(std::format_string<Args...> fmt, Args&&... args)
+{
+    thread_local std::string buffer;
+    buffer.clear();
+    std::format_to(std::back_inserter(buffer), fmt, std::forward<Args>(args)...);
+    return buffer;
+}
 } // namespace detail
 
 } // namespace blaze::logger
 
 #ifdef _DEBUG
-    #define LOG_TRACE(msg, ...) blaze::logger::detail::output(blaze::logger::log_level::trace, std::format(msg, ##__VA_ARGS__))
-    #define LOG_DEBUG(msg, ...) blaze::logger::detail::output(blaze::logger::log_level::debug, std::format(msg, ##__VA_ARGS__))
-    #define LOG_INFO(msg, ...)  blaze::logger::detail::output(blaze::logger::log_level::info, std::format(msg, ##__VA_ARGS__))
-    #define LOG_WARN(msg, ...)  blaze::logger::detail::output(blaze::logger::log_level::warn, std::format(msg, ##__VA_ARGS__))
-    #define LOG_ERROR(msg, ...) blaze::logger::detail::output(blaze::logger::log_level::error, std::format(msg, ##__VA_ARGS__))
-    #define LOG_FATAL(msg, ...) blaze::logger::detail::output(blaze::logger::log_level::fatal, std::format(msg, ##__VA_ARGS__))
+    #define LOG_TRACE(msg, ...) blaze::logger::detail::output(blaze::logger::log_level::trace, blaze::logger::detail::format(msg, ##__VA_ARGS__))
+    #define LOG_DEBUG(msg, ...) blaze::logger::detail::output(blaze::logger::log_level::debug, blaze::logger::detail::format(msg, ##__VA_ARGS__))
+    #define LOG_INFO(msg, ...)  blaze::logger::detail::output(blaze::logger::log_level::info, blaze::logger::detail::format(msg, ##__VA_ARGS__))
+    #define LOG_WARN(msg, ...)  blaze::logger::detail::output(blaze::logger::log_level::warn, blaze::logger::detail::format(msg, ##__VA_ARGS__))
+    #define LOG_ERROR(msg, ...) blaze::logger::detail::output(blaze::logger::log_level::error, blaze::logger::detail::format(msg, ##__VA_ARGS__))
+    #define LOG_FATAL(msg, ...) blaze::logger::detail::output(blaze::logger::log_level::fatal, blaze::logger::detail::format(msg, ##__VA_ARGS__))
 #else
     #define LOG_TRACE(msg, ...)
     #define LOG_DEBUG(msg, ...)
@@ -0,0 +1,275 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_MEMORY_H
+#define BLAZE_MEMORY_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "Types.h"
+
+namespace blaze::memory
+{
+
+// Allocation counters are kept per subsystem so a regression points somewhere
+enum class subsystem : u8
+{
+    general,
+    core,
+    graphics,
+    text,
+
+    count
+};
+
+struct usage
+{
+    u64 allocations{};
+    u64 frees{};
+    u64 live_bytes{};
+    u64 peak_bytes{};
+};
+
+void        record_allocation(subsystem tag, u64 bytes);
+void        record_free(subsystem tag, u64 bytes);
+usage       subsystem_usage(subsystem tag);
+const char* subsystem_name(subsystem tag);
+
+// Bump allocator. Nothing is freed individually, reset() drops everything at once. Running out mid frame falls back to
+// extra heap blocks, and the next reset() grows the main block to cover them, so a steady workload settles at zero
+// heap allocations
+class linear_arena
+{
+public:
+    explicit linear_arena(u64 capacity = 256 * 1024, subsystem tag = subsystem::core);
+    ~linear_arena();
+    linear_arena(const linear_arena&)            = delete;
+    linear_arena& operator=(const linear_arena&) = delete;
+
+    void* allocate(u64 size, u64 alignment = alignof(std::max_align_t));
+    void  reset();
+
+    constexpr u64 used() const { return m_offset + m_overflow_bytes; }
+    constexpr u64 capacity() const { return m_capacity; }
+    constexpr u64 high_water() const { return m_high_water; }
+
+private:
+    u8*              m_base{ nullptr };
+    u64              m_capacity{};
+    u64              m_offset{};
+    u64              m_overflow_bytes{};
+    u64              m_high_water{};
+    std::vector<u8*> m_overflow{};
+    subsystem        m_tag{};
+};
+
+// The calling thread's frame arena. run() resets the main thread's at the end of every frame, other threads reset
+// their own when their unit of work is done. Anything allocated from it is gone after that
+linear_arena& frame_arena();
+
+// STL allocator over frame_arena(), deallocate is a no-op
+template<typename T>
+struct frame_allocator
+{
+    using value_type = T;
+
+    frame_allocator() = default;
+    template<typename U>
+    constexpr frame_allocator(const frame_allocator<U>&) noexcept
+    {}
+
+    T*   allocate(size_t count) { return (T*) frame_arena().allocate(count * sizeof(T), alignof(T)); }
+    void deallocate(T*, size_t) noexcept {}
+
+    template<typename U>
+    constexpr bool operator==(const frame_allocator<U>&) const noexcept
+    {
+        return true;
+    }
+};
+
+template<typename T>
+using frame_vector = std::vector<T, frame_allocator<T>>;
+
+// STL allocator on the global heap that counts against a subsystem
+template<typename T>
+struct tracking_allocator
+{
+    using value_type = T;
+
+    subsystem tag{ subsystem::general };
+
+    tracking_allocator() = default;
+    constexpr explicit tracking_allocator(subsystem t) noexcept : tag(t) {}
+    template<typename U>
+    constexpr tracking_allocator(const tracking_allocator<U>& other) noexcept : tag(other.tag)
+    {}
+
+    T* allocate(size_t count)
+    {
+        record_allocation(tag, count * sizeof(T));
+        return (T*) ::operator new(count * sizeof(T));
+    }
+    void deallocate(T* p, size_t count) noexcept
+    {
+        record_free(tag, count * sizeof(T));
+        ::operator delete(p);
+    }
+
+    template<typename U>
+    constexpr bool operator==(const tracking_allocator<U>& other) const noexcept
+    {
+        return tag == other.tag;
+    }
+};
+
+// Fixed size slots in blocks of slots_per_block, recycled through a free list. Not thread safe
+template<typename T>
+class pool
+{
+public:
+    explicit pool(subsystem tag = subsystem::general, u32 slots_per_block = 64) :
+        m_tag(tag), m_slots_per_block(slots_per_block)
+    {}
+    ~pool()
+    {
+        for (slot* block : m_blocks)
+        {
+            record_free(m_tag, (u64) m_slots_per_block * sizeof(slot));
+            delete[] block;
+        }
+    }
+    pool(const pool&)            = delete;
+    pool& operator=(const pool&) = delete;
+
+    template<typename... Args>
+        requires constructible_from_args<T, Args...>
+    T* create(Args&&... args)
+    {
+        if (!m_free)
+        {
+            grow();
+        }
+        slot* s = m_free;
+        m_free  = s->next;
+        ++m_live;
+        return new (s->storage) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* object)
+    {
+        if (!object)
+        {
+            return;
+        }
+        object->~T();
+        auto* s = (slot*) object;
+        s->next = m_free;
+        m_free  = s;
+        --m_live;
+    }
+
+    constexpr u32       live() const { return m_live; }
+    constexpr u32       capacity() const { return (u32) m_blocks.size() * m_slots_per_block; }
+    constexpr subsystem tag() const { return m_tag; }
+
+private:
+    union slot
+    {
+        slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    std::vector<slot*> m_blocks{};
+    slot*              m_free{ nullptr };
+    u32                m_live{};
+    subsystem          m_tag{};
+    u32                m_slots_per_block{};
+
+    void grow()
+    {
+        auto* block = new slot[m_slots_per_block];
+        record_allocation(m_tag, (u64) m_slots_per_block * sizeof(slot));
+        for (u32 i = 0; i < m_slots_per_block; ++i)
+        {
+            block[i].next = i + 1 < m_slots_per_block ? &block[i + 1] : m_free;
+        }
+        m_free = block;
+        m_blocks.emplace_back(block);
+    }
+};
+
+// Smart pointers that hand their object back to where it came from
+template<typename T>
+struct pool_deleter
+{
+    pool<T>* owner{ nullptr };
+
+    void operator()(T* object) const { owner->destroy(object); }
+};
+
+template<typename T>
+using pool_uptr = std::unique_ptr<T, pool_deleter<T>>;
+
+template<typename T, typename... Args>
+    requires constructible_from_args<T, Args...>
+pool_uptr<T> make_pool_uptr(pool<T>& owner, Args&&... args)
+{
+    return pool_uptr<T>(owner.create(std::forward<Args>(args)...), pool_deleter<T>{ &owner });
+}
+
+// The control block can't live in the pool's slots, it goes on the heap counted against the pool's subsystem
+template<typename T, typename... Args>
+    requires constructible_from_args<T, Args...>
+sptr<T> make_pool_sptr(pool<T>& owner, Args&&... args)
+{
+    return sptr<T>(owner.create(std::forward<Args>(args)...), pool_deleter<T>{ &owner },
+                   tracking_allocator<T>{ owner.tag() });
+}
+
+// make_sptr with the object and control block counted against a subsystem, still one allocation
+template<typename T, typename... Args>
+    requires constructible_from_args<T, Args...>
+sptr<T> make_tracked_sptr(subsystem tag, Args&&... args)
+{
+    return std::allocate_shared<T>(tracking_allocator<T>{ tag }, std::forward<Args>(args)...);
+}
+
+struct frame_stats
+{
+    u64 heap_allocations{}; // every global operator new in the frame, needs BLAZE_TRACK_ALLOCATIONS
+    u64 arena_bytes{};      // main thread frame arena
+};
+const frame_stats& last_frame();
+
+// True when built with BLAZE_TRACK_ALLOCATIONS, otherwise heap_allocations stays 0
+bool heap_tracking();
+u64  heap_allocations(); // process total
+
+namespace detail
+{
+// Records the frame's numbers and resets the main thread's frame arena
+void end_frame();
+} // namespace detail
+
+} // namespace blaze::memory
+
+#endif //BLAZE_MEMORY_H
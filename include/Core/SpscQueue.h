@@ -0,0 +1,91 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_SPSCQUEUE_H
+#define BLAZE_SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+#include "Types.h"
+
+namespace blaze
+{
+
+// Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+// Each side caches the other side's index so the shared cache line is only touched when the queue looks full/empty.
+template<typename T, u32 Capacity>
+    requires(std::is_trivially_copyable_v<T> && Capacity > 1 && (Capacity & (Capacity - 1)) == 0)
+class spsc_queue
+{
+public:
+    // Producer only. Returns false if the queue is full
+    bool push(const T& value)
+    {
+        const u32 head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cached_tail == Capacity)
+        {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cached_tail == Capacity)
+            {
+                return false;
+            }
+        }
+        m_data[head & mask] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false if the queue is empty
+    bool pop(T& out)
+    {
+        const u32 tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cached_head)
+        {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail == m_cached_head)
+            {
+                return false;
+            }
+        }
+        out = m_data[tail & mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    u32 size_approx() const { return m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_relaxed); }
+
+    static constexpr u32 capacity() { return Capacity; }
+
+private:
+    static constexpr u32 mask = Capacity - 1;
+
+    alignas(64) std::atomic<u32> m_head{ 0 };
+    u32 m_cached_tail{ 0 };
+
+    alignas(64) std::atomic<u32> m_tail{ 0 };
+    u32 m_cached_head{ 0 };
+
+    alignas(64) std::array<T, Capacity> m_data{};
+};
+
+} // namespace blaze
+
+#endif //BLAZE_SPSCQUEUE_H
@@ -28,30 +28,69 @@ class SDL_Window;
 namespace blaze
 {
 
+enum class backend : u8
+{
+    windowed, // SDL windows with a shared GL context
+    headless, // surfaceless EGL context, every window is an offscreen framebuffer
+};
+
+// Generational handle into the window registry. A handle to a destroyed window stays invalid even once its slot is reused
+struct window_handle
+{
+    u32 index{ u32_invalid_id };
+    u32 generation{};
+
+    constexpr bool is_valid() const { return index != u32_invalid_id; }
+    constexpr explicit operator bool() const { return is_valid(); }
+    constexpr bool operator==(const window_handle&) const = default;
+};
+
 class window
 {
 public:
     bool create(const std::string& title, i32 width, i32 height);
+    // Call on the active window
     void swap();
     void destroy();
+    // Binds this window as the draw surface of the shared context, a no-op if it already is
     void activate();
+    // SDL reported a new drawable size. Offscreen targets keep their size
+    void resized(i32 width, i32 height);
+    // The interval belongs to the drawable with GLX/EGL swap control, so each window keeps its own. Only reaches the
+    // driver when it changes, at the next activate() unless this window is already current. -1 is adaptive and falls
+    // back to 1 where unsupported
+    void set_swap_interval(i32 interval);
 
     constexpr i32 width() const { return m_width; }
     constexpr i32 height() const { return m_height; }
+    constexpr u32 id() const { return m_id; }
+    constexpr bool alive() const { return m_alive; }
+    // Offscreen target of a headless window, 0 (the default framebuffer) for a real one
+    constexpr u32 framebuffer() const { return m_framebuffer; }
+    constexpr u32 color_texture() const { return m_color; }
 
     SDL_Window* handle() const;
 
 private:
     i32         m_width{};
     i32         m_height{};
+    u32         m_id{};
     bool        m_alive{ false };
     SDL_Window* m_window{ nullptr };
-    void*       m_context{ nullptr };
+    u32         m_framebuffer{};
+    u32         m_color{};
+    u32         m_depth{};
+    i32         m_swap_interval{};
+    bool        m_interval_dirty{ true };
+
+    bool create_offscreen();
+    void apply_swap_interval();
 };
 
 
-bool init_graphics();
-void shutdown_graphics();
+bool    init_graphics(backend mode);
+void    shutdown_graphics();
+backend graphics_backend();
 
 } // namespace blaze
 
@@ -0,0 +1,81 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_WINDOWREGISTRY_H
+#define BLAZE_WINDOWREGISTRY_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/HashedId.h"
+#include "Core/Window.h"
+
+namespace blaze
+{
+
+// Windows live in a dense slot array addressed by window_handle. Routing an SDL event or activating a window by handle
+// never touches a string; titles are only a lookup table kept around for the string based API.
+class window_registry
+{
+public:
+    window_handle create(const std::string& title, i32 width, i32 height);
+    void          destroy(window_handle handle);
+    void          clear();
+
+    window*       get(window_handle handle);
+    const window* get(window_handle handle) const;
+
+    // Titles are interned, "Title"_id finds a window without hashing at runtime
+    window_handle find(hashed_id title) const;
+    window_handle find(const std::string& title) const;
+    window_handle from_sdl_id(u32 id) const;
+
+    u32 size() const { return (u32) m_titles.size(); }
+
+    template<typename Fn>
+    void for_each(Fn&& fn)
+    {
+        for (u32 i = 0; i < (u32) m_slots.size(); ++i)
+        {
+            if (m_slots[i].used)
+            {
+                fn(window_handle{ i, m_slots[i].generation }, m_slots[i].wnd);
+            }
+        }
+    }
+
+private:
+    struct slot
+    {
+        window    wnd{};
+        hashed_id title{};
+        u32       generation{};
+        bool      used{ false };
+    };
+
+    std::vector<slot>                            m_slots{};
+    std::vector<u32>                             m_free_slots{};
+    std::unordered_map<u32, window_handle>       m_sdl_ids{};
+    std::unordered_map<hashed_id, window_handle> m_titles{};
+};
+
+} // namespace blaze
+
+#endif //BLAZE_WINDOWREGISTRY_H
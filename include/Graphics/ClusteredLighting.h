@@ -0,0 +1,146 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_CLUSTEREDLIGHTING_H
+#define BLAZE_CLUSTEREDLIGHTING_H
+
+#include <span>
+#include <vector>
+
+#include "Types.h"
+#include "Graphics/Shader.h"
+#include "Graphics/UniformBlocks.h"
+
+namespace blaze::gfx
+{
+
+// SSBO bindings shared with the shaders, see clustered_bench.fs
+constexpr u32 cluster_lights_binding  = 3;
+constexpr u32 cluster_grid_binding    = 4;
+constexpr u32 cluster_indices_binding = 5;
+
+// Matches the std430 light_data struct in the shaders
+struct light
+{
+    f32 position[3]{}; // view space
+    f32 radius{ 1.0f };
+    f32 color[3]{ 1.0f, 1.0f, 1.0f };
+    f32 intensity{ 1.0f };
+    f32 direction[3]{ 0.0f, 0.0f, -1.0f }; // view space, spot lights only
+    f32 spot_cos{ -1.0f };                 // cosine of the outer cone angle, -1 makes it a point light
+};
+BLAZE_ASSERT_OFFSET(light, position, 0);
+BLAZE_ASSERT_OFFSET(light, radius, 12);
+BLAZE_ASSERT_OFFSET(light, color, 16);
+BLAZE_ASSERT_OFFSET(light, intensity, 28);
+BLAZE_ASSERT_OFFSET(light, direction, 32);
+BLAZE_ASSERT_OFFSET(light, spot_cos, 44);
+static_assert(sizeof(light) == 48);
+
+enum class light_assignment : u8
+{
+    cpu, // SoA loops on the render thread, then uploaded
+    gpu, // compute shader, nothing crosses the bus but the lights
+};
+
+struct cluster_settings
+{
+    u32              tiles_x{ 16 };
+    u32              tiles_y{ 9 };
+    u32              slices{ 24 }; // exponential in depth
+    u32              max_lights{ 16384 };
+    u32              max_lights_per_cluster{ 256 };
+    u32              max_indices{ 1u << 20 }; // total light references over all clusters
+    light_assignment assignment{ light_assignment::cpu };
+};
+
+// Clustered forward shading: the view frustum is cut into tiles_x * tiles_y * slices clusters and every frame each
+// cluster gets the list of lights whose bounding sphere touches it. Fragment shaders find their cluster from
+// gl_FragCoord and view depth and only loop over that list.
+class clustered_lighting
+{
+public:
+    clustered_lighting() = default;
+    ~clustered_lighting();
+
+    bool create(const cluster_settings& settings);
+    void destroy();
+
+    // Symmetric perspective projection, fov_y in radians. Rebuilds the cluster bounds
+    void set_projection(f32 fov_y, f32 aspect, f32 near_plane, f32 far_plane, i32 screen_width, i32 screen_height);
+
+    // Lights in view space. Assigns and uploads, call once per frame before drawing lit geometry
+    void update(std::span<const light> lights);
+
+    // Binds the SSBOs and sets the u_cluster_* uniforms on a program using clustered.glsl
+    void bind(const shader& program) const;
+
+    struct stats
+    {
+        f64 assign_ms{}; // CPU time spent in update()
+        u32 light_count{};
+        u32 index_count{}; // light references written, cpu mode only
+        u32 overflowed{};  // references dropped because a cluster or the index buffer was full, cpu mode only
+    };
+    constexpr const stats& last_stats() const { return m_stats; }
+
+    constexpr u32 cluster_count() const { return m_settings.tiles_x * m_settings.tiles_y * m_settings.slices; }
+
+private:
+    cluster_settings m_settings{};
+    stats            m_stats{};
+    f32              m_near{};
+    f32              m_far{};
+    f32              m_z_scale{}; // slice = log(depth) * scale + bias
+    f32              m_z_bias{};
+    i32              m_screen_width{};
+    i32              m_screen_height{};
+
+    // Cluster bounds in view space. A cluster's AABB is its column's x range and row's y range at its slice, so they
+    // are stored per slice/column and per slice/row and tested one axis at a time
+    std::vector<f32> m_column_min{};
+    std::vector<f32> m_column_max{};
+    std::vector<f32> m_row_min{};
+    std::vector<f32> m_row_max{};
+    std::vector<f32> m_slice_near{}; // positive depth
+    std::vector<f32> m_slice_far{};
+
+    // cpu assignment scratch, reused across frames
+    std::vector<u32> m_counts{};
+    std::vector<u32> m_grid{}; // offset, count pairs
+    std::vector<u32> m_indices{};
+    std::vector<u32> m_pairs{}; // cluster, light pairs
+    std::vector<f32> m_column_d2{}; // squared distance from the light to each column/row of the current slice
+    std::vector<f32> m_row_d2{};
+
+    u32          m_lights_buffer{};
+    u32          m_grid_buffer{};
+    u32          m_indices_buffer{};
+    u32          m_bounds_buffer{};  // gpu mode: min/max per cluster
+    u32          m_counter_buffer{}; // gpu mode: running index count
+    shader*      m_assign{};         // owned by shaders()
+
+    void assign_cpu(std::span<const light> lights);
+    void assign_gpu(u32 light_count);
+    u32  slice_of(f32 depth) const;
+};
+
+} // namespace blaze::gfx
+
+#endif //BLAZE_CLUSTEREDLIGHTING_H
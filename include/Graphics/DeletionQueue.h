@@ -0,0 +1,72 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_DELETIONQUEUE_H
+#define BLAZE_DELETIONQUEUE_H
+
+#include "Types.h"
+
+namespace blaze::gfx
+{
+
+enum class gl_object : u8
+{
+    buffer,
+    texture,
+    renderbuffer,
+    framebuffer,
+    vertex_array,
+    program,
+    query,
+
+    count
+};
+
+// Deferred deletion of GL objects. Deleting something the GPU may still be using forces the driver to sync, so retired
+// objects are batched per frame behind that frame's fence and released together once the GPU is past it. There is one
+// context (windows share it, see Window.cpp), so there's one queue. Once the queue is flushed at shutdown, retire()
+// deletes immediately
+namespace deletion
+{
+// bytes is only for the stats, pass what the object holds if it's known
+void retire(gl_object type, u32 id, u64 bytes = 0);
+
+struct stats
+{
+    u32 pending_objects{};
+    u64 pending_bytes{};
+    u32 pending_batches{};                // frames whose fence hasn't passed yet
+    u64 released_objects{};               // since init
+    u32 counts[(u32) gl_object::count]{}; // pending, per type
+};
+const stats& pending();
+
+namespace detail
+{
+void init();
+// Closes the frame's batch behind a fence and releases every batch the GPU is done with
+void end_frame();
+// Waits for the GPU and releases everything, the context must still be current
+void flush();
+} // namespace detail
+} // namespace deletion
+
+} // namespace blaze::gfx
+
+#endif //BLAZE_DELETIONQUEUE_H
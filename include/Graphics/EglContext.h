@@ -0,0 +1,36 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_EGLCONTEXT_H
+#define BLAZE_EGLCONTEXT_H
+
+#include "Types.h"
+
+// Surfaceless EGL context for the headless backend. Rendering goes to FBOs only, which lets the engine run on
+// machines without a display (llvmpipe included)
+namespace blaze::gfx::egl
+{
+bool available();
+bool create_context();
+void destroy_context();
+// nullptr without EGL
+void* get_proc_address(const char* name);
+} // namespace blaze::gfx::egl
+
+#endif //BLAZE_EGLCONTEXT_H
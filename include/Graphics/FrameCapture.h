@@ -0,0 +1,131 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_FRAMECAPTURE_H
+#define BLAZE_FRAMECAPTURE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Types.h"
+#include "Graphics/Shader.h"
+
+namespace blaze::gfx
+{
+
+enum class capture_format : u8
+{
+    rgba8, // 4 bytes per pixel, rows bottom to top like glReadPixels
+    nv12,  // converted on the GPU, 1.5 bytes per pixel, rows top to bottom
+};
+
+struct captured_frame
+{
+    const u8*      data{ nullptr };
+    u64            size{};
+    i32            width{};
+    i32            height{};
+    capture_format format{};
+    u64            index{}; // sequence number of the capture() call that produced it
+};
+
+// Asynchronous readback through a ring of pixel pack buffers. capture() only queues GPU work and a fence; poll()
+// hands over whichever captures the GPU has finished, typically ring_size - 1 frames later. Nothing here waits on the
+// GPU except flush().
+class frame_capture
+{
+public:
+    using callback = std::function<void(const captured_frame&)>;
+
+    frame_capture() = default;
+    ~frame_capture();
+
+    bool create(i32 width, i32 height, capture_format format, u32 ring_size = 3);
+    void destroy();
+
+    // Called on the render thread while the buffer is mapped, or on the worker thread with a copy
+    void set_callback(callback cb);
+    // Copies finished frames out and runs the callback on a worker thread instead of the render thread. Call after create()
+    void use_worker_thread(bool enable);
+
+    // Captures color attachment 0 of a framebuffer, 0 for the current window's back buffer
+    bool capture_framebuffer(u32 framebuffer);
+    // Only takes textures for nv12, rgba8 goes through capture_framebuffer
+    bool capture_texture(u32 texture);
+
+    void poll();
+    // Waits for every capture in flight, use before tearing down
+    void flush();
+
+    constexpr u64 dropped() const { return m_dropped; }
+    constexpr u64 frame_size() const { return m_frame_size; }
+
+private:
+    struct slot
+    {
+        u32   buffer{};
+        void* fence{ nullptr };
+        u64   index{};
+    };
+
+    struct job
+    {
+        std::vector<u8> data{};
+        u64             index{};
+    };
+
+    std::vector<slot> m_ring{};
+    u32               m_head{};    // next slot to write
+    u32               m_pending{}; // slots in flight, oldest at m_head - m_pending
+    u64               m_next_index{};
+    u64               m_dropped{};
+    u64               m_frame_size{};
+    i32               m_width{};
+    i32               m_height{};
+    capture_format    m_format{};
+    callback          m_callback{};
+
+    // nv12: window captures are blitted into m_staging first so the compute pass can sample them
+    uptr<shader> m_convert{};
+    u32          m_staging{};
+    u32          m_staging_fbo{};
+
+    std::thread                  m_worker{};
+    std::mutex                   m_mutex{};
+    std::condition_variable      m_wake{};
+    std::deque<job>              m_jobs{};
+    std::vector<std::vector<u8>> m_free_buffers{};
+    bool                         m_stop{ false };
+
+    slot* acquire();
+    void  submit(slot& s);
+    void  convert(slot& s, u32 texture); // nv12 compute pass into the slot's buffer, then submit
+    bool  retire(bool wait);
+    void  deliver(const slot& s, const u8* data);
+    void  stop_worker();
+    void  worker_main();
+};
+
+} // namespace blaze::gfx
+
+#endif //BLAZE_FRAMECAPTURE_H
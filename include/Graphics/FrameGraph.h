@@ -0,0 +1,193 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_FRAMEGRAPH_H
+#define BLAZE_FRAMEGRAPH_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Types.h"
+
+namespace blaze::gfx
+{
+
+enum class texture_format : u8
+{
+    rgba8,
+    rgba16f,
+    r32f,
+    depth24_stencil8,
+    depth32f,
+};
+
+struct texture_desc
+{
+    i32            width{};
+    i32            height{};
+    texture_format format{ texture_format::rgba8 };
+
+    constexpr bool operator==(const texture_desc&) const = default;
+};
+
+u64 texture_bytes(const texture_desc& desc);
+
+struct frame_resource
+{
+    u32 index{ u32_invalid_id };
+
+    constexpr bool is_valid() const { return index != u32_invalid_id; }
+};
+
+class frame_graph;
+
+// Handed to a pass' setup function to declare what it touches
+class pass_builder
+{
+public:
+    // Transient texture, only lives between its first and last use and may reuse the pooled texture of an identically
+    // described transient whose lifetime doesn't overlap
+    frame_resource create(const std::string& name, const texture_desc& desc);
+    frame_resource read(frame_resource resource);
+    // Written resources become the pass' framebuffer attachments
+    frame_resource write(frame_resource resource);
+    // Keeps the pass even if nothing reads what it writes
+    void side_effect();
+
+private:
+    friend class frame_graph;
+    pass_builder(frame_graph& graph, u32 pass) : m_graph(graph), m_pass(pass) {}
+
+    frame_graph& m_graph;
+    u32          m_pass;
+};
+
+// Handed to a pass' execute function to look up the GL textures behind its resources
+class pass_resources
+{
+public:
+    u32                 texture(frame_resource resource) const;
+    const texture_desc& desc(frame_resource resource) const;
+
+private:
+    friend class frame_graph;
+    explicit pass_resources(const frame_graph& graph) : m_graph(graph) {}
+
+    const frame_graph& m_graph;
+};
+
+// Passes are declared every frame, compile() culls the ones that don't contribute to an imported resource, orders the
+// rest so passes drawing to the same targets run back to back, and maps identically described transient textures
+// whose lifetimes don't overlap onto the same physical texture. Physical textures and framebuffers are pooled across
+// frames.
+class frame_graph
+{
+public:
+    using setup_function   = std::function<void(pass_builder&)>;
+    using execute_function = std::function<void(const pass_resources&)>;
+
+    frame_graph() = default;
+    ~frame_graph();
+
+    // Imported resources are what the frame is for, passes writing to them are never culled
+    frame_resource import_texture(const std::string& name, const texture_desc& desc, u32 texture);
+    // A window's framebuffer (0 for the default one). Can't be combined with other attachments in a pass
+    frame_resource import_framebuffer(const std::string& name, i32 width, i32 height, u32 framebuffer);
+
+    void add_pass(const std::string& name, const setup_function& setup, const execute_function& execute);
+
+    bool compile();
+    void execute();
+    // Drops this frame's passes and resources, pooled textures are kept for the next frame
+    void reset();
+    // Frees pooled textures and framebuffers
+    void release();
+
+    std::string dump() const;
+
+    struct stats
+    {
+        u32 passes{};
+        u32 culled_passes{};
+        u32 framebuffer_binds{};
+        u64 transient_bytes{}; // physical textures after pooling
+        u64 unpooled_bytes{};  // if every transient had its own texture
+    };
+    constexpr const stats& last_stats() const { return m_stats; }
+
+private:
+    friend class pass_builder;
+    friend class pass_resources;
+
+    struct resource
+    {
+        std::string  name{};
+        texture_desc desc{};
+        bool         imported{ false };
+        u32          texture{};          // physical texture once compiled
+        u32          framebuffer{};      // imported framebuffers only
+        bool         is_framebuffer{ false };
+        u32          physical{ u32_invalid_id };
+        u32          first_use{ u32_invalid_id };
+        u32          last_use{};
+    };
+
+    struct pass
+    {
+        std::string      name{};
+        execute_function execute{};
+        std::vector<u32> reads{};
+        std::vector<u32> writes{};
+        bool             side_effect{ false };
+        bool             culled{ false };
+    };
+
+    struct physical_texture
+    {
+        texture_desc desc{};
+        u32          texture{};
+        u32          last_user{ u32_invalid_id }; // order index of the last pass using it this frame
+        bool         in_use{ false };
+    };
+
+    struct cached_framebuffer
+    {
+        u32              framebuffer{};
+        std::vector<u32> textures{}; // attachments, it's dropped once one of them is freed
+    };
+
+    std::vector<resource>                       m_resources{};
+    std::vector<pass>                           m_passes{};
+    std::vector<u32>                            m_order{};
+    std::vector<physical_texture>               m_physical{};
+    std::unordered_map<u64, cached_framebuffer> m_framebuffers{}; // keyed by a hash of the attached textures
+    stats                                       m_stats{};
+    bool                                        m_compiled{ false };
+
+    void cull();
+    void sort();
+    void assign_physical();
+    u32  framebuffer_for(const pass& p);
+};
+
+} // namespace blaze::gfx
+
+#endif //BLAZE_FRAMEGRAPH_H
@@ -20,15 +20,38 @@
 #ifndef BLAZE_GLCORE_H
 #define BLAZE_GLCORE_H
 
+#include <string>
+
 #include "Types.h"
 namespace blaze::gfx
 {
-bool init();
+struct renderer_info
+{
+    std::string vendor{};
+    std::string renderer{}; // e.g. "llvmpipe (LLVM 15.0.6, 256 bits)", tag perf results with this
+    std::string version{};
+};
+
+// Looks up a GL entry point for the current context: SDL_GL_GetProcAddress or eglGetProcAddress
+using proc_loader = void* (*)(const char* name);
+
+// Fails if any entry point the engine uses can't be resolved
+bool init(proc_loader get_proc_address);
+// Releases the engine's GL objects and drains the deletion queue, the context has to still be current
+void shutdown();
+
+// Filled in by init()
+const renderer_info& renderer();
 
 void clear_screen(f32 r, f32 g, f32 b);
 
 void test_shader();
 
+// Three vertices generated from gl_VertexID, no vertex buffer involved
+void draw_fullscreen_triangle();
+// Waits for the GPU to finish everything queued, only for measurements
+void finish();
+
 }
 
 #endif //BLAZE_GLCORE_H
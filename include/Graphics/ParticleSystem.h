@@ -0,0 +1,116 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_PARTICLESYSTEM_H
+#define BLAZE_PARTICLESYSTEM_H
+
+#include <array>
+
+#include "Types.h"
+#include "Graphics/Shader.h"
+
+namespace blaze::gfx
+{
+
+struct particle_emitter
+{
+    f32 position[3]{};
+    f32 velocity[3]{ 0.0f, 2.0f, 0.0f };
+    f32 color[4]{ 1.0f, 0.6f, 0.2f, 1.0f };
+    f32 spread{ 1.0f }; // random velocity added per axis, +-spread
+    f32 lifetime{ 2.0f };
+    f32 lifetime_jitter{ 0.5f };
+    f32 rate{ 10000.0f }; // particles per second
+};
+
+// Particle state lives in SSBOs and never leaves the GPU. Each update runs four compute passes: kickoff (clamps the
+// emission to the free slots and sizes the other dispatches), emit (pops the dead list), simulate (integrates and
+// compacts survivors into the other alive list) and finalize (writes the indirect draw). Draws are sized by the
+// GPU-side alive count, the CPU never reads it back to render.
+class particle_system
+{
+public:
+    particle_system() = default;
+    ~particle_system();
+
+    bool create(u32 capacity);
+    void destroy();
+
+    void set_emitter(const particle_emitter& emitter) { m_emitter = emitter; }
+    void set_gravity(f32 x, f32 y, f32 z);
+
+    void update(f32 dt);
+    // Additive blended quads, placed with the view_block pushed for the current view
+    void render(f32 size = 0.02f);
+
+    struct stats
+    {
+        u32 alive{};             // from a few frames ago, read back asynchronously for reporting only
+        f64 simulate_ms{};       // GPU time of the four compute passes
+        f64 particles_per_ms{};
+    };
+    constexpr const stats& last_stats() const { return m_stats; }
+
+    constexpr u32 capacity() const { return m_capacity; }
+
+private:
+    static constexpr u32 stats_latency = 3;
+
+    // GPU timer query and a copy of the counters from the same frame, collected once both are available
+    struct stats_slot
+    {
+        u32   query{};
+        u32   counters{};
+        void* fence{ nullptr };
+        u32   current{}; // alive list the frame simulated from
+        bool  pending{ false };
+    };
+
+    particle_emitter m_emitter{};
+    stats            m_stats{};
+    f32              m_gravity[3]{ 0.0f, -9.81f, 0.0f };
+    f32              m_emit_accumulator{};
+    u32              m_capacity{};
+    u32              m_current{};
+    u32              m_seed{};
+    u32              m_frame{};
+
+    u32 m_counters{};
+    u32 m_particles{};
+    u32 m_dead_list{};
+    u32 m_alive[2]{};
+    u32 m_indirect{};
+    u32 m_vao{};
+
+    std::array<stats_slot, stats_latency> m_stats_ring{};
+
+    // Owned by shaders()
+    shader* m_kickoff{};
+    shader* m_emit{};
+    shader* m_simulate{};
+    shader* m_finalize{};
+    shader* m_render{};
+
+    void bind_buffers() const;
+    void collect_stats();
+};
+
+} // namespace blaze::gfx
+
+#endif //BLAZE_PARTICLESYSTEM_H
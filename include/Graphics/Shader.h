@@ -20,34 +20,97 @@
 #ifndef BLAZE_SHADER_H
 #define BLAZE_SHADER_H
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "Types.h"
+#include "Core/HashedId.h"
+#include "Graphics/ShaderPreprocessor.h"
 
 namespace blaze::gfx{
 
 class shader{
 public:
-    shader(std::string  shader_name);
+    // defines are injected after #version in every stage, see preprocessor::process
+    shader(std::string  shader_name, define_set defines = {});
     ~shader();
+    // Registered with hot reload by address
+    shader(const shader&)            = delete;
+    shader& operator=(const shader&) = delete;
 
     bool load();
+    // Loads <name>.cs as a compute program instead of the .vs/.fs pair
+    bool load_compute();
     void bind() const;
     void destroy();
 
+    // Locations are reflected once per link, so setting a uniform by "u_name"_id is a lookup in a small table instead
+    // of a glGetUniformLocation round trip. -1 for names that aren't active uniforms, which GL ignores
+    i32 location(hashed_id name) const;
+
+    void set_bool(hashed_id name, bool value) const;
+    void set_int(hashed_id name, i32 value) const;
+    void set_float(hashed_id name, f32 value) const;
+    void set_vec3(hashed_id name, const f32* value) const;
+    void set_vec4(hashed_id name, const f32* value) const;
+    // Column major, like GL
+    void set_mat4(hashed_id name, const f32* value) const;
+
+    // Hash the name on every call, for names built at runtime
     void set_bool(const std::string& name, bool value) const;
     void set_int(const std::string& name, i32 value) const;
     void set_float(const std::string& name, f32 value) const;
+    void set_vec3(const std::string& name, const f32* value) const;
+    void set_vec4(const std::string& name, const f32* value) const;
+    void set_mat4(const std::string& name, const f32* value) const;
+
+    // Starts compiling the sources again without waiting for the driver. The current program stays in use until
+    // poll_reload() sees the new one linked successfully
+    void reload();
+    // True when a reload finished and the new program was swapped in
+    bool poll_reload();
+    // Files relative to the shaders path the last successful build read, includes too
+    bool depends_on(const std::string& file) const;
 
 private:
+    // The GL objects of one compile, status isn't queried until finish_build so the driver can work in the background
+    struct build
+    {
+        u32                      program{};
+        u32                      stages[2]{};
+        std::vector<std::string> files[2]{}; // per stage, to map info logs back to file names
+        u32                      stage_count{};
+        void*                    fence{ nullptr }; // behind the link when the driver can't report completion itself
+    };
+
     u32 m_id{u32_invalid_id};
     std::string m_name{};
     std::string m_vertex_file{};
     std::string m_fragment_file{};
 
-    bool compile(const std::string& vertex_shader, const std::string& fragment_shader);
+    std::string m_compute_file{};
+    define_set m_defines{};
+    bool m_compute{};
+    std::vector<std::string> m_dependencies{};
+    build m_pending{};
+    std::unordered_map<hashed_id, i32> m_locations{};
+
+    void cache_locations();
+    bool start_build(build& b) const;
+    bool finish_build(build& b);
+    static void discard_build(build& b);
 };
 
 [[maybe_unused]] void set_shaders_path(const std::string& path);
 
+// Watches the shaders path and recompiles every live program that reads a changed file, includes too. Uses
+// KHR/ARB_parallel_shader_compile where available so compiles never stall the frame. Linux only, false elsewhere
+bool enable_hot_reload();
+void disable_hot_reload();
+// Once per frame, called by run()
+void update_hot_reload();
+
 }
 
 #endif //BLAZE_SHADER_H
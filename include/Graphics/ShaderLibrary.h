@@ -0,0 +1,64 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_SHADERLIBRARY_H
+#define BLAZE_SHADERLIBRARY_H
+
+#include <string>
+#include <unordered_map>
+
+#include "Types.h"
+#include "Core/Memory.h"
+#include "Graphics/Shader.h"
+
+namespace blaze::gfx
+{
+
+// Permutations of a program, compiled the first time they're asked for. Each (program, define set) pair is compiled
+// once, including failures, so a broken variant logs its errors once rather than every frame
+class shader_library
+{
+public:
+    // nullptr if the variant failed to compile. Define order doesn't matter
+    shader* get(const std::string& program, const define_set& defines = {});
+    shader* get_compute(const std::string& program, const define_set& defines = {});
+
+    // Skips hashing the define set, for callers that keep preprocessor::variant_key() around. Compute variants need
+    // the key made with compute = true
+    shader* find(u64 key) const;
+
+    void clear();
+
+    u32           size() const { return (u32) m_variants.size(); }
+    constexpr u32 compiled() const { return m_compiled; }
+
+private:
+    memory::pool<shader>                               m_pool{ memory::subsystem::graphics, 32 }; // outlives m_variants
+    std::unordered_map<u64, memory::pool_uptr<shader>> m_variants{};
+    u32                                                m_compiled{};
+
+    shader* get(const std::string& program, const define_set& defines, bool compute);
+};
+
+// The engine's library, everything built in goes through it. Cleared by gfx::shutdown() while the context is current
+shader_library& shaders();
+
+} // namespace blaze::gfx
+
+#endif //BLAZE_SHADERLIBRARY_H
@@ -0,0 +1,62 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_SHADERPREPROCESSOR_H
+#define BLAZE_SHADERPREPROCESSOR_H
+
+#include <string>
+#include <vector>
+
+#include "Types.h"
+
+namespace blaze::gfx
+{
+
+struct shader_define
+{
+    std::string name{};
+    std::string value{ "1" };
+};
+
+using define_set = std::vector<shader_define>;
+
+struct preprocessed_source
+{
+    std::string              text{};
+    std::vector<std::string> files{}; // every file pulled in, indexed by the source string number used in #line
+};
+
+namespace preprocessor
+{
+// Resolves #include "file" (relative to root) and injects the defines right after #version. Every file is included at
+// most once per program, so guards and #pragma once are optional. #line directives are emitted around each include so
+// compiler messages can be mapped back with remap_log()
+bool process(const std::string& root, const std::string& file, const define_set& defines, preprocessed_source& out);
+
+// Replaces the source string numbers in a driver's info log with the file names
+std::string remap_log(const std::string& log, const std::vector<std::string>& files);
+
+// 64 bit key of a program, its stage set and a define set, independent of the order the defines were given in. A
+// compute program and a .vs/.fs pair of the same name get different keys
+u64 variant_key(const std::string& program, const define_set& defines, bool compute = false);
+} // namespace preprocessor
+
+} // namespace blaze::gfx
+
+#endif //BLAZE_SHADERPREPROCESSOR_H
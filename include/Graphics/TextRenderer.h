@@ -0,0 +1,153 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_TEXTRENDERER_H
+#define BLAZE_TEXTRENDERER_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Types.h"
+#include "Core/Memory.h"
+#include "Graphics/Shader.h"
+
+namespace blaze::gfx
+{
+
+struct font_handle
+{
+    u32 index{ u32_invalid_id };
+
+    constexpr bool is_valid() const { return index != u32_invalid_id; }
+    constexpr explicit operator bool() const { return is_valid(); }
+};
+
+// Signed distance field text. Glyphs are rendered into shared atlas pages the first time they're used, laid out
+// strings are cached by font and content so a label that doesn't change costs a hash and a compare per frame, and
+// everything queued in a frame goes out as one instanced draw per atlas page.
+class text_renderer
+{
+public:
+    text_renderer() = default;
+    ~text_renderer();
+
+    bool create(u32 atlas_size = 1024, u32 max_glyphs = 1u << 18);
+    void destroy();
+
+    // pixel_size is the size glyphs are rasterized at, the distance field lets them scale from there
+    font_handle load_font(const std::string& file, u32 pixel_size = 48);
+
+    // x, y is the top left corner in pixels, y pointing down. scale is relative to the font's pixel_size
+    void draw(font_handle handle, std::string_view text, f32 x, f32 y, f32 scale, const f32* color);
+    // Width and height in pixels at scale 1, lays the text out (and caches it) if needed
+    void measure(font_handle handle, std::string_view text, f32& width, f32& height);
+
+    void flush(i32 screen_width, i32 screen_height);
+
+    struct stats
+    {
+        u32 glyphs{};      // drawn last flush
+        u32 batches{};
+        u32 cached_runs{};
+        u32 run_misses{}; // strings laid out since the previous flush
+        u32 pages{};
+    };
+    constexpr const stats& last_stats() const { return m_stats; }
+
+private:
+    struct glyph
+    {
+        f32 offset_x{}; // quad position relative to the pen, y down
+        f32 offset_y{};
+        f32 width{};
+        f32 height{};
+        f32 uv[4]{};
+        f32 advance{};
+        u32 index{};                // FreeType glyph index, for kerning
+        u32 page{ u32_invalid_id }; // invalid for glyphs with nothing to draw, e.g. spaces
+    };
+
+    struct font
+    {
+        void*                          face{ nullptr }; // FT_Face
+        f32                            ascender{};
+        f32                            line_height{};
+        std::unordered_map<u32, glyph> glyphs{};
+    };
+
+    struct page
+    {
+        u32 texture{};
+        u32 cursor_x{};
+        u32 cursor_y{};
+        u32 shelf_height{};
+    };
+
+    // Instance layout of text_sdf.vs
+    struct glyph_instance
+    {
+        f32 rect[4]; // x, y, width, height in pixels
+        f32 uv[4];
+        u32 color;   // rgba8
+    };
+
+    struct run_glyph
+    {
+        f32 rect[4];
+        f32 uv[4];
+        u32 page;
+    };
+
+    struct run
+    {
+        std::string            text{};
+        std::vector<run_glyph> glyphs{};
+        f32                    width{};
+        f32                    height{};
+        u64                    last_used{};
+    };
+
+    using run_cache = std::unordered_multimap<u64, run, std::hash<u64>, std::equal_to<u64>,
+                                              memory::tracking_allocator<std::pair<const u64, run>>>;
+
+    void*                                    m_library{ nullptr }; // FT_Library
+    u32                                      m_atlas_size{};
+    u32                                      m_max_glyphs{};
+    u64                                      m_frame{};
+    std::vector<font>                        m_fonts{};
+    std::vector<page>                        m_pages{};
+    std::vector<std::vector<glyph_instance>> m_batches{}; // per page
+    run_cache                                m_runs{ memory::tracking_allocator<run_cache::value_type>{ memory::subsystem::text } };
+    stats                                    m_stats{};
+    u32                                      m_run_misses{};
+
+    u32          m_vao{};
+    u32          m_instances{};
+    uptr<shader> m_shader{};
+
+    const glyph* find_glyph(font& f, u32 codepoint);
+    bool         pack(u32 width, u32 height, u32& page_index, u32& x, u32& y);
+    const run&   layout(font_handle handle, std::string_view text);
+};
+
+} // namespace blaze::gfx
+
+#endif //BLAZE_TEXTRENDERER_H
@@ -0,0 +1,187 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#ifndef BLAZE_UNIFORMBLOCKS_H
+#define BLAZE_UNIFORMBLOCKS_H
+
+#include <concepts>
+#include <cstddef>
+#include <string>
+
+#include "Types.h"
+
+// Pins a member to the offset the GLSL side computes for it, so a layout mistake is a compile error instead of garbage
+// on screen. Works for std140 and std430 structs alike
+#define BLAZE_ASSERT_OFFSET(type, member, offset)                                                                        \
+    static_assert(offsetof(type, member) == (offset), #type "::" #member " is not at offset " #offset)
+
+namespace blaze::gfx
+{
+
+// GLSL types with their std140/std430 alignment. vec3 takes 16 bytes like it does in an array, put a scalar in the
+// padding by hand if it matters
+namespace glsl
+{
+struct alignas(8) vec2
+{
+    f32 x{}, y{};
+};
+
+struct alignas(16) vec3
+{
+    f32 x{}, y{}, z{};
+};
+
+struct alignas(16) vec4
+{
+    f32 x{}, y{}, z{}, w{};
+};
+
+struct alignas(16) mat4
+{
+    f32 m[16]{ 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f }; // column major
+};
+} // namespace glsl
+
+// Binding points, one per update frequency so e.g. a material switch only rebinds the material range
+enum class uniform_slot : u32
+{
+    frame,
+    view,
+    material,
+    object,
+
+    count
+};
+
+struct block_member
+{
+    const char* name;
+    u32         offset;
+};
+
+// Mirrors of the blocks in uniform_blocks.glsl
+struct frame_block
+{
+    static constexpr const char*  block_name = "frame_data";
+    static constexpr uniform_slot slot       = uniform_slot::frame;
+
+    f32        time{};       // seconds since run()
+    f32        delta_time{};
+    u32        frame_index{};
+    u32        padding{};
+    glsl::vec4 resolution{}; // width, height, 1 / width, 1 / height of the default window
+};
+BLAZE_ASSERT_OFFSET(frame_block, time, 0);
+BLAZE_ASSERT_OFFSET(frame_block, delta_time, 4);
+BLAZE_ASSERT_OFFSET(frame_block, frame_index, 8);
+BLAZE_ASSERT_OFFSET(frame_block, resolution, 16);
+static_assert(sizeof(frame_block) == 32);
+
+struct view_block
+{
+    static constexpr const char*  block_name = "view_data";
+    static constexpr uniform_slot slot       = uniform_slot::view;
+
+    glsl::mat4 view{};
+    glsl::mat4 projection{};
+    glsl::mat4 view_projection{};
+    glsl::vec4 camera_position{};
+    glsl::vec4 viewport{}; // width, height, 1 / width, 1 / height
+};
+BLAZE_ASSERT_OFFSET(view_block, view, 0);
+BLAZE_ASSERT_OFFSET(view_block, projection, 64);
+BLAZE_ASSERT_OFFSET(view_block, view_projection, 128);
+BLAZE_ASSERT_OFFSET(view_block, camera_position, 192);
+BLAZE_ASSERT_OFFSET(view_block, viewport, 208);
+static_assert(sizeof(view_block) == 224);
+
+struct material_block
+{
+    static constexpr const char*  block_name = "material_data";
+    static constexpr uniform_slot slot       = uniform_slot::material;
+
+    glsl::vec4 base_color{ 1.f, 1.f, 1.f, 1.f };
+    f32        roughness{ 1.f };
+    f32        metallic{};
+    f32        emissive{};
+    f32        alpha_cutoff{};
+};
+BLAZE_ASSERT_OFFSET(material_block, base_color, 0);
+BLAZE_ASSERT_OFFSET(material_block, roughness, 16);
+BLAZE_ASSERT_OFFSET(material_block, metallic, 20);
+BLAZE_ASSERT_OFFSET(material_block, emissive, 24);
+BLAZE_ASSERT_OFFSET(material_block, alpha_cutoff, 28);
+static_assert(sizeof(material_block) == 32);
+
+struct object_block
+{
+    static constexpr const char*  block_name = "object_data";
+    static constexpr uniform_slot slot       = uniform_slot::object;
+
+    glsl::mat4 model{};
+    glsl::mat4 normal_matrix{}; // inverse transpose of model, as a mat4 to dodge std140 mat3 padding
+};
+BLAZE_ASSERT_OFFSET(object_block, model, 0);
+BLAZE_ASSERT_OFFSET(object_block, normal_matrix, 64);
+static_assert(sizeof(object_block) == 128);
+
+template<typename T>
+concept uniform_block = std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T> && requires {
+    { T::block_name } -> std::convertible_to<const char*>;
+    { T::slot } -> std::convertible_to<uniform_slot>;
+};
+
+// Per frame ring of uniform data. Blocks are copied with one memcpy into a persistently mapped buffer, each at
+// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, and bound with glBindBufferRange. The ring is as deep as the frames in flight,
+// with a fence per frame so a range is never overwritten while the GPU may still read it
+namespace uniforms
+{
+bool init(u32 frame_bytes = 1u << 20);
+void shutdown();
+
+struct stats
+{
+    u32 bytes{}; // used last frame, alignment padding included
+    u32 uploads{};
+    u32 overflows{}; // pushes dropped because the frame's range was full
+};
+const stats& last_stats();
+
+// Binds every engine block the program uses to its slot and checks its size and member offsets against reflection.
+// Called by shader after linking, false if a block doesn't match its C++ mirror
+bool validate_program(u32 program, const std::string& name);
+
+namespace detail
+{
+void begin_frame();
+void end_frame();
+bool push(uniform_slot slot, const void* data, u32 size);
+} // namespace detail
+
+template<uniform_block T>
+bool push(const T& block)
+{
+    return detail::push(T::slot, &block, (u32) sizeof(T));
+}
+} // namespace uniforms
+
+} // namespace blaze::gfx
+
+#endif //BLAZE_UNIFORMBLOCKS_H
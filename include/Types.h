@@ -43,9 +43,6 @@ constexpr u16 u16_invalid_id = 0xffffui16;
 constexpr u32 u32_invalid_id = 0xffff'ffffui32;
 constexpr u64 u64_invalid_id = 0xffff'ffff'ffff'ffffui64;
 
-// may go unused, we'll see
-using string_hash = std::hash<std::string>;
-
 // Useful concepts
 template<typename T, typename... Args>
 concept constructible_from_args = std::constructible_from<T, Args...>;
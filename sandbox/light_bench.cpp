@@ -0,0 +1,193 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+// Clustered lighting benchmark: a lit ground plane with 100 to 10k lights, CPU and GPU light assignment.
+// Pass --headless to run without a display.
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Blaze.h"
+#include "Graphics/GLCore.h"
+#include "Graphics/ClusteredLighting.h"
+
+using namespace blaze::literals;
+
+namespace
+{
+constexpr i32 width           = 1280;
+constexpr i32 height          = 720;
+constexpr f32 fov_y           = 1.0471976f; // 60 degrees
+constexpr f32 near_plane      = 0.1f;
+constexpr f32 far_plane       = 100.0f;
+constexpr f32 ground_height   = -2.0f;
+constexpr u32 warmup_frames   = 30;
+constexpr u32 measured_frames = 120;
+
+constexpr std::array<u32, 5> light_counts{ 100, 1000, 2500, 5000, 10000 };
+constexpr std::array<blaze::gfx::light_assignment, 2> modes{ blaze::gfx::light_assignment::cpu,
+                                                             blaze::gfx::light_assignment::gpu };
+
+bool headless  = false;
+u32  mode      = 0;
+u32  step      = 0;
+u32  frame     = 0;
+f64  frame_ms  = 0.0;
+f64  assign_ms = 0.0;
+
+std::vector<blaze::gfx::light> lights;
+blaze::gfx::clustered_lighting clusters;
+uptr<blaze::gfx::shader>       program;
+
+std::vector<blaze::gfx::light> make_lights(u32 count)
+{
+    std::mt19937                        rng{ count };
+    std::uniform_real_distribution<f32> x{ -30.0f, 30.0f };
+    std::uniform_real_distribution<f32> y{ ground_height + 0.2f, ground_height + 3.0f };
+    std::uniform_real_distribution<f32> z{ -80.0f, -1.0f };
+    std::uniform_real_distribution<f32> radius{ 1.5f, 5.0f };
+    std::uniform_real_distribution<f32> unit{ 0.0f, 1.0f };
+
+    std::vector<blaze::gfx::light> result(count);
+    for (auto& l : result)
+    {
+        l.position[0] = x(rng);
+        l.position[1] = y(rng);
+        l.position[2] = z(rng);
+        l.radius      = radius(rng);
+        l.color[0]    = unit(rng);
+        l.color[1]    = unit(rng);
+        l.color[2]    = unit(rng);
+        l.intensity   = 2.0f;
+        // A quarter of them are spot lights pointing down
+        if (unit(rng) < 0.25f)
+        {
+            l.direction[0] = 0.0f;
+            l.direction[1] = -1.0f;
+            l.direction[2] = 0.0f;
+            l.spot_cos     = 0.8f;
+        }
+    }
+    return result;
+}
+
+bool start_mode()
+{
+    blaze::gfx::cluster_settings settings{};
+    settings.assignment = modes[mode];
+    if (!clusters.create(settings))
+    {
+        return false;
+    }
+    clusters.set_projection(fov_y, (f32) width / (f32) height, near_plane, far_plane, width, height);
+    return true;
+}
+
+void start_step()
+{
+    lights    = make_lights(light_counts[step]);
+    frame     = 0;
+    frame_ms  = 0.0;
+    assign_ms = 0.0;
+}
+
+void finish_step()
+{
+    // stdout rather than the logger, results have to show up in release builds
+    std::cout << std::format("[{}] {} assignment, {:>5} lights: frame {:.3f}ms, assign {:.3f}ms (cpu side)",
+                             blaze::gfx::renderer().renderer,
+                             modes[mode] == blaze::gfx::light_assignment::cpu ? "cpu" : "gpu", light_counts[step],
+                             frame_ms / measured_frames, assign_ms / measured_frames)
+              << std::endl;
+
+    if (++step < light_counts.size())
+    {
+        start_step();
+        return;
+    }
+
+    step = 0;
+    if (++mode == modes.size() || !start_mode())
+    {
+        blaze::quit();
+        return;
+    }
+    start_step();
+}
+
+void render()
+{
+    if (frame >= warmup_frames)
+    {
+        frame_ms += blaze::loop::delta_time() * 1000.0;
+        assign_ms += clusters.last_stats().assign_ms;
+    }
+
+    clusters.update(lights);
+    clusters.bind(*program);
+    program->set_float("u_tan_half_fov_y"_id, std::tan(fov_y * 0.5f));
+    program->set_float("u_tan_half_fov_x"_id, std::tan(fov_y * 0.5f) * (f32) width / (f32) height);
+    program->set_float("u_far"_id, far_plane);
+    program->set_float("u_ground_height"_id, ground_height);
+
+    blaze::gfx::clear_screen(0.f, 0.f, 0.f);
+    blaze::gfx::draw_fullscreen_triangle();
+    if (headless)
+    {
+        // Nothing throttles the CPU without a swap, wait so frame times include the GPU work
+        blaze::gfx::finish();
+    }
+
+    if (++frame == warmup_frames + measured_frames)
+    {
+        finish_step();
+    }
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    headless = argc > 1 && std::strcmp(argv[1], "--headless") == 0;
+    if (!blaze::init(headless ? blaze::backend::headless : blaze::backend::windowed))
+    {
+        std::cout << "Blaze failed to initialize!" << std::endl;
+        return 1;
+    }
+
+    if (blaze::create_window("Light bench", width, height))
+    {
+        program = make_uptr<blaze::gfx::shader>("clustered_bench");
+        if (program->load() && start_mode())
+        {
+            start_step();
+            blaze::loop::configure({ .vsync = blaze::loop::vsync_mode::off });
+            blaze::set_render_function(render);
+            blaze::run();
+        }
+        clusters.destroy();
+        program.reset();
+    }
+
+    blaze::shutdown();
+    return 0;
+}
@@ -17,26 +17,100 @@
 //
 //  ------------------------------------------------------------------------------
 
+#include <cstring>
+#include <format>
 #include <iostream>
 #include "Blaze.h"
+#include "Core/Memory.h"
+#include "Graphics/DeletionQueue.h"
 #include "Graphics/GLCore.h"
+#include "Graphics/ParticleSystem.h"
+#include "Graphics/TextRenderer.h"
+#include "Graphics/UniformBlocks.h"
+
+using namespace blaze::literals;
+
+bool                        headless = false;
+blaze::gfx::particle_system particles;
+blaze::gfx::text_renderer   text;
+blaze::gfx::font_handle     font;
+std::string                 stats_label{ "Collecting stats..." };
 
 void render()
 {
     blaze::gfx::clear_screen(0.2f, 0.f, 0.f);
     blaze::gfx::test_shader();
 
-    blaze::gfx::activate_window("Test");
+    // Identity camera, the fountain lives in clip space
+    blaze::gfx::view_block view{};
+    view.viewport = { 1280.f, 720.f, 1.f / 1280.f, 1.f / 720.f };
+    blaze::gfx::uniforms::push(view);
+    particles.render();
+
+    constexpr f32 white[4] = { 1.f, 1.f, 1.f, 1.f };
+    text.draw(font, stats_label, 10.f, 10.f, 0.5f, white);
+    text.flush(1280, 720);
+
+    blaze::gfx::activate_window("Test"_id);
     blaze::gfx::clear_screen(0.f, 0.2f, 0.f);
 
-    blaze::gfx::activate_window("Test2");
+    blaze::gfx::activate_window("Test2"_id);
     blaze::gfx::clear_screen(0.f, 0.f, 0.2f);
+
+    // Headless runs are perf tests, render a fixed number of frames and report
+    if (headless && blaze::loop::frame_stats().frame_count + 1 >= 1000)
+    {
+        const auto& stats = blaze::loop::frame_stats();
+        // stdout rather than the logger, the measurement has to show up in release builds
+        std::cout << std::format("[{}] p50 {:.3f}ms, p99 {:.3f}ms", blaze::gfx::renderer().renderer, stats.p50_ms,
+                                 stats.p99_ms)
+                  << std::endl;
+        blaze::quit();
+    }
+}
+
+void update(f64 dt)
+{
+    blaze::input::event e;
+    while (blaze::input::poll(e))
+    {
+        if (e.type == blaze::input::event_type::mouse_down)
+        {
+            LOG_INFO("Mouse button {} pressed at {}, {}", e.code, e.x, e.y);
+        }
+    }
+
+    particles.update((f32) dt);
+
+    static f64 elapsed = 0.0;
+    elapsed += dt;
+    if (elapsed >= 5.0)
+    {
+        const auto& stats = blaze::loop::frame_stats();
+        std::cout << std::format("Frame time avg {:.2f}ms, p50 {:.2f}ms, p99 {:.2f}ms", stats.average_ms, stats.p50_ms,
+                                 stats.p99_ms)
+                  << std::endl;
+        LOG_INFO("Input latency avg {:.2f}ms", blaze::input::latency().average_ms);
+        std::cout << std::format("Particles: {} alive, {:.0f} particles/ms", particles.last_stats().alive,
+                                 particles.last_stats().particles_per_ms)
+                  << std::endl;
+        if (blaze::memory::heap_tracking())
+        {
+            LOG_INFO("Heap allocations last frame: {}", blaze::memory::last_frame().heap_allocations);
+        }
+        LOG_INFO("GL objects pending deletion: {}, {:.1f}KB", blaze::gfx::deletion::pending().pending_objects,
+                 (f64) blaze::gfx::deletion::pending().pending_bytes / 1024.0);
+        stats_label = std::format("{:.2f}ms avg\n{:.2f}ms p99\n{} particles", stats.average_ms, stats.p99_ms,
+                                  particles.last_stats().alive);
+        elapsed = 0.0;
+    }
 }
 
-int main()
+int main(int argc, char** argv)
 {
     LOG_INFO("Sandbox started");
-    if (blaze::init())
+    headless = argc > 1 && std::strcmp(argv[1], "--headless") == 0;
+    if (blaze::init(headless ? blaze::backend::headless : blaze::backend::windowed))
     {
         std::cout << "Sandbox can run now" << std::endl;
     } else
@@ -47,8 +121,30 @@ int main()
     if (blaze::create_window("Sandbox", 1280, 720) && blaze::create_window("Test", 400, 400) &&
         blaze::create_window("Test2", 400, 400))
     {
+        blaze::gfx::particle_emitter emitter{};
+        emitter.position[1] = -0.5f;
+        emitter.velocity[1] = 1.0f;
+        emitter.spread      = 0.3f;
+        emitter.rate        = 100'000.0f;
+        particles.set_emitter(emitter);
+        particles.set_gravity(0.f, -0.5f, 0.f);
+        particles.create(500'000);
+
+        // No font ships with the repo, drop any TTF here to get the overlay
+        if (text.create())
+        {
+            font = text.load_font("./assets/fonts/default.ttf");
+        }
+
+#ifdef _DEBUG
+        blaze::gfx::enable_hot_reload();
+#endif
+        blaze::loop::configure({ .target_fps = 144.0, .vsync = blaze::loop::vsync_mode::adaptive });
+        blaze::set_update_function(update);
         blaze::set_render_function(render);
         blaze::run();
+        particles.destroy();
+        text.destroy();
     }
 
     blaze::shutdown();
@@ -0,0 +1,186 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+// SDF text benchmark: 10k to 200k glyphs a frame, with labels that stay the same and labels that change every frame.
+// Pass --headless to run without a display, and a TTF path to use something other than the sandbox font.
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Blaze.h"
+#include "Graphics/GLCore.h"
+#include "Graphics/TextRenderer.h"
+
+namespace
+{
+constexpr i32 width           = 1280;
+constexpr i32 height          = 720;
+constexpr u32 label_length    = 64; // no spaces, every character is a drawn glyph
+constexpr u32 labels_per_row  = 16;
+constexpr f32 scale           = 0.1f;
+constexpr u32 warmup_frames   = 30;
+constexpr u32 measured_frames = 120;
+
+constexpr std::array<u32, 4> glyph_counts{ 10'000, 50'000, 100'000, 200'000 };
+
+bool headless = false;
+bool changing = false; // second pass, every label is laid out again each frame
+u32  step     = 0;
+u32  frame    = 0;
+u64  glyphs   = 0;
+f64  frame_ms = 0.0;
+f64  text_ms  = 0.0;
+
+blaze::gfx::text_renderer text;
+blaze::gfx::font_handle   font;
+std::vector<std::string>  labels;
+
+std::string make_label(u32 index, u32 salt)
+{
+    std::string label = std::format("L{:06}F{:06}", index, salt);
+    while (label.size() < label_length)
+    {
+        label += (char) ('A' + (label.size() + index) % 26);
+    }
+    return label;
+}
+
+void start_step()
+{
+    labels.resize(glyph_counts[step] / label_length);
+    for (u32 i = 0; i < labels.size(); ++i)
+    {
+        labels[i] = make_label(i, 0);
+    }
+    frame    = 0;
+    glyphs   = 0;
+    frame_ms = 0.0;
+    text_ms  = 0.0;
+}
+
+void finish_step()
+{
+    // stdout rather than the logger, results have to show up in release builds
+    const f64 average_glyphs = (f64) glyphs / measured_frames;
+    std::cout << std::format("[{}] {} labels, {:>6.0f} glyphs: frame {:.3f}ms, text {:.3f}ms (cpu side), {:.0f} glyphs/ms",
+                             blaze::gfx::renderer().renderer, changing ? "changing" : "cached", average_glyphs,
+                             frame_ms / measured_frames, text_ms / measured_frames,
+                             average_glyphs / (frame_ms / measured_frames))
+              << std::endl;
+
+    if (++step < glyph_counts.size())
+    {
+        start_step();
+        return;
+    }
+
+    step = 0;
+    if (changing)
+    {
+        blaze::quit();
+        return;
+    }
+    changing = true;
+    start_step();
+}
+
+void render()
+{
+    if (frame >= warmup_frames)
+    {
+        frame_ms += blaze::loop::delta_time() * 1000.0;
+    }
+
+    if (changing)
+    {
+        for (u32 i = 0; i < labels.size(); ++i)
+        {
+            labels[i] = make_label(i, frame + 1);
+        }
+    }
+
+    blaze::gfx::clear_screen(0.f, 0.f, 0.f);
+
+    constexpr f32 white[4] = { 1.f, 1.f, 1.f, 1.f };
+    const auto    start    = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < labels.size(); ++i)
+    {
+        const f32 x = (f32) (i % labels_per_row) * ((f32) width / labels_per_row);
+        const f32 y = (f32) (i / labels_per_row % 140) * 5.f;
+        text.draw(font, labels[i], x, y, scale, white);
+    }
+    text.flush(width, height);
+    const f64 elapsed = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (headless)
+    {
+        // Nothing throttles the CPU without a swap, wait so frame times include the GPU work
+        blaze::gfx::finish();
+    }
+
+    if (frame >= warmup_frames)
+    {
+        text_ms += elapsed;
+        glyphs += text.last_stats().glyphs;
+    }
+    if (++frame == warmup_frames + measured_frames)
+    {
+        finish_step();
+    }
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    headless                  = argc > 1 && std::strcmp(argv[1], "--headless") == 0;
+    const i32   font_argument = headless ? 2 : 1;
+    const char* font_file     = argc > font_argument ? argv[font_argument] : "./assets/fonts/default.ttf";
+
+    if (!blaze::init(headless ? blaze::backend::headless : blaze::backend::windowed))
+    {
+        std::cout << "Blaze failed to initialize!" << std::endl;
+        return 1;
+    }
+
+    if (blaze::create_window("Text bench", width, height))
+    {
+        if (text.create())
+        {
+            font = text.load_font(font_file);
+        }
+        if (font)
+        {
+            start_step();
+            blaze::loop::configure({ .vsync = blaze::loop::vsync_mode::off });
+            blaze::set_render_function(render);
+            blaze::run();
+        } else
+        {
+            std::cout << std::format("No font at {}, pass a TTF path", font_file) << std::endl;
+        }
+        text.destroy();
+    }
+
+    blaze::shutdown();
+    return 0;
+}
@@ -18,34 +18,124 @@
 //  ------------------------------------------------------------------------------
 #include "Blaze.h"
 
+#include <array>
 #include <SDL.h>
 
+#include "Core/Memory.h"
 #include "Graphics/GLCore.h"
+#include "Graphics/DeletionQueue.h"
+#include "Graphics/Shader.h"
+#include "Graphics/UniformBlocks.h"
 
 namespace blaze
 {
 
 namespace
 {
-bool                                          running = false;
-bool                                          is_init = false;
-std::string                                   default_window{};
-std::string                                   current_window{};
-std::unordered_map<std::string, uptr<window>> window_map{};
+bool            running = false;
+bool            is_init = false;
+window_handle   default_window{};
+window_handle   current_window{};
+window_registry registry{};
 
-std::function<void()> render_function;
+std::function<void()>    render_function;
+std::function<void(f64)> update_function;
+
+constexpr i32 event_batch_size = 64;
+
+void push_frame_block(f64 elapsed)
+{
+    gfx::frame_block block{};
+    block.time        = (f32) elapsed;
+    block.delta_time  = (f32) loop::delta_time();
+    block.frame_index = (u32) loop::frame_stats().frame_count;
+    if (const window* primary = registry.get(default_window))
+    {
+        const f32 width  = (f32) primary->width();
+        const f32 height = (f32) primary->height();
+        block.resolution = { width, height, 1.0f / width, 1.0f / height };
+    }
+    gfx::uniforms::push(block);
+}
+
+void handle_event(const SDL_Event& event)
+{
+    if ((event.type == SDL_WINDOWEVENT) && (event.window.event == SDL_WINDOWEVENT_CLOSE))
+    {
+        destroy_window(registry.from_sdl_id(event.window.windowID));
+    } else if ((event.type == SDL_WINDOWEVENT) && (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED))
+    {
+        if (window* wnd = registry.get(registry.from_sdl_id(event.window.windowID)))
+        {
+            wnd->resized(event.window.data1, event.window.data2);
+        }
+    } else if (event.type == SDL_QUIT)
+    {
+        running = false;
+    } else
+    {
+        input::detail::process(event);
+    }
+}
+
+// Drains SDL's queue a batch at a time rather than one SDL_PollEvent call (and internal pump) per event
+void pump_events()
+{
+    std::array<SDL_Event, event_batch_size> events;
+    input::detail::begin_frame();
+    SDL_PumpEvents();
+
+    i32 count;
+    do
+    {
+        count = SDL_PeepEvents(events.data(), event_batch_size, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+        for (i32 i = 0; i < count; ++i)
+        {
+            handle_event(events[i]);
+        }
+    } while (count == event_batch_size);
+
+    input::detail::end_frame();
+}
+
+// Swaps every window once. Only the default window waits on vblank, otherwise each extra window would cost
+// another refresh interval. Intervals are per window and only reach the driver when they change
+void present_windows()
+{
+    const i32 interval = loop::detail::swap_interval();
+    registry.for_each([interval](window_handle handle, window& wnd) {
+        if (handle != default_window)
+        {
+            wnd.set_swap_interval(0);
+            wnd.activate();
+            wnd.swap();
+        }
+    });
+
+    if (window* primary = registry.get(default_window))
+    {
+        primary->set_swap_interval(interval);
+        primary->activate();
+        current_window = default_window;
+        primary->swap();
+    }
+}
 } // anonymous namespace
 
-bool init()
+bool init(backend mode)
 {
     if (is_init)
     {
         return false;
     }
-    if (!init_graphics())
+    if (!init_graphics(mode))
     {
         return false;
     }
+    if (mode == backend::windowed)
+    {
+        input::detail::init();
+    }
     is_init = true;
     return true;
 }
@@ -56,11 +146,15 @@ void shutdown()
     {
         return;
     }
-    for (auto& [title, window] : window_map)
-    {
-        window->destroy();
-    }
+    // GL objects go first. The shared context lives on a hidden window, so it's still current even when every window
+    // has been closed already
+    input::detail::shutdown();
+    gfx::activate_window(default_window);
+    gfx::shutdown();
 
+    registry.clear();
+    default_window = {};
+    current_window = {};
     shutdown_graphics();
     is_init = false;
 }
@@ -72,86 +166,133 @@ void run()
         return;
     }
     running = true;
+
+    const bool headless = graphics_backend() == backend::headless;
+    gfx::activate_window(default_window);
+    loop::detail::start(!headless);
+
+    f64 elapsed = 0.0;
     while (running)
     {
-        gfx::activate_window(default_window);
-        render_function();
+        const u32 steps = loop::detail::begin_frame();
+        elapsed += loop::delta_time();
 
-        SDL_Event event;
-        while (SDL_PollEvent(&event))
+        if (!headless)
         {
-            if ((event.type == SDL_WINDOWEVENT) && (event.window.event == SDL_WINDOWEVENT_CLOSE))
-            {
-                for (auto& [title, window] : window_map)
-                {
-                    if (SDL_GetWindowFromID(event.window.windowID) == window->handle())
-                    {
-                        window->destroy();
-                        break;
-                    }
-                }
-            }
-            if (event.type == SDL_QUIT)
+            pump_events();
+        }
+
+        if (update_function)
+        {
+            const f64 step = loop::current_settings().fixed_step;
+            for (u32 i = 0; i < steps; ++i)
             {
-                running = false;
-                break;
+                update_function(step);
             }
         }
-        //        for (auto& [title, window] : window_map)
-        //        {
-        //            window->swap();
-        //        }
+
+        gfx::activate_window(default_window);
+        gfx::update_hot_reload();
+        gfx::uniforms::detail::begin_frame();
+        push_frame_block(elapsed);
+        if (render_function)
+        {
+            render_function();
+        }
+        gfx::uniforms::detail::end_frame();
+        gfx::deletion::detail::end_frame();
+
+        if (!headless)
+        {
+            present_windows();
+            input::detail::frame_presented();
+        }
+        loop::detail::end_frame();
+        memory::detail::end_frame();
     }
 }
 
-const std::unordered_map<std::string, uptr<window>>& windows()
+void quit()
 {
-    return window_map;
+    running = false;
 }
 
-bool create_window(const std::string& title, i32 width, i32 height)
+const window_registry& windows()
 {
-    auto window = make_uptr<blaze::window>();
-    if (window->create(title, width, height))
+    return registry;
+}
+
+window_handle create_window(const std::string& title, i32 width, i32 height)
+{
+    const window_handle handle = registry.create(title, width, height);
+    // First created window will be the default window to render to
+    if (handle && !default_window)
     {
-        window_map.emplace(title, std::move(window));
-        // First created window will be the default window to render to
-        if (current_window.empty())
-        {
-            default_window = title;
-            current_window = title;
-        }
-        return true;
+        default_window = handle;
+        current_window = handle;
     }
-    return false;
+    return handle;
 }
 
-void destroy_window(const std::string& title)
+void destroy_window(window_handle handle)
 {
-    auto it = window_map.find(title);
-    if (it != window_map.end())
+    if (handle == current_window)
+    {
+        current_window = {};
+    }
+    registry.destroy(handle);
+
+    // Closing the default window hands the role to any window still open, render_function keeps a target and the
+    // frame block keeps a resolution
+    if (handle == default_window)
     {
-        it->second->destroy();
-        window_map.erase(it);
+        default_window = {};
+        registry.for_each([](window_handle other, window&) {
+            if (!default_window)
+            {
+                default_window = other;
+            }
+        });
     }
 }
+
+void destroy_window(hashed_id title)
+{
+    destroy_window(registry.find(title));
+}
+
+void destroy_window(const std::string& title)
+{
+    destroy_window(registry.find(title));
+}
+
 void set_render_function(const std::function<void()>& rf)
 {
     render_function = rf;
 }
 
+void set_update_function(const std::function<void(f64)>& uf)
+{
+    update_function = uf;
+}
 
-void gfx::activate_window(const std::string& title)
+
+void gfx::activate_window(window_handle handle)
 {
-    auto it = window_map.find(title);
-    if (it != window_map.end())
+    if (window* wnd = registry.get(handle))
     {
-        if (current_window != title)
-        {
-            window_map[current_window]->swap();
-            current_window = title;
-        }
-        it->second->activate();
+        wnd->activate();
+        current_window = handle;
     }
 }
-} // namespace blaze
\ No newline at end of file
+
+void gfx::activate_window(hashed_id title)
+{
+    activate_window(registry.find(title));
+}
+
+void gfx::activate_window(const std::string& title)
+{
+    activate_window(registry.find(title));
+}
+} // namespace blaze
@@ -0,0 +1,193 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#include "Core/FileWatcher.h"
+
+#include <filesystem>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "Core/Logger.h"
+
+namespace blaze
+{
+
+namespace
+{
+constexpr i32 poll_timeout_ms = 100; // how long stop() may wait for the thread to notice
+} // anonymous namespace
+
+file_watcher::~file_watcher()
+{
+    stop();
+}
+
+#ifdef __linux__
+
+bool file_watcher::start(const std::string& directory, u32 debounce_ms)
+{
+    stop();
+
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0)
+    {
+        LOG_ERROR("inotify_init1 failed, file watching is off");
+        return false;
+    }
+
+    m_root     = directory;
+    m_debounce = std::chrono::milliseconds(debounce_ms);
+    watch_tree("");
+    if (m_directories.empty())
+    {
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_running = true;
+    m_thread  = std::thread(&file_watcher::run, this);
+    return true;
+}
+
+void file_watcher::stop()
+{
+    m_running = false;
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd); // drops every watch with it
+        m_fd = -1;
+    }
+    m_directories.clear();
+
+    std::lock_guard lock{ m_mutex };
+    m_pending.clear();
+}
+
+void file_watcher::watch_tree(const std::string& relative)
+{
+    // Moves cover editors that write a temporary and rename it over the original
+    constexpr u32 mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    const std::string path = m_root + relative;
+    const i32         wd   = inotify_add_watch(m_fd, path.c_str(), mask);
+    if (wd < 0)
+    {
+        LOG_WARN("Can't watch {}", path);
+        return;
+    }
+    m_directories[wd] = relative;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(path, error))
+    {
+        if (entry.is_directory(error))
+        {
+            watch_tree(relative + entry.path().filename().string() + "/");
+        }
+    }
+}
+
+void file_watcher::run()
+{
+    // inotify_event is variable length, the buffer has to be aligned for the header
+    alignas(inotify_event) char buffer[4096];
+    pollfd                      descriptor{ m_fd, POLLIN, 0 };
+
+    while (m_running)
+    {
+        if (poll(&descriptor, 1, poll_timeout_ms) <= 0)
+        {
+            continue;
+        }
+
+        ssize_t length;
+        while ((length = read(m_fd, buffer, sizeof(buffer))) > 0)
+        {
+            const auto now = clock::now();
+            for (char* cursor = buffer; cursor < buffer + length;)
+            {
+                const auto* event = (const inotify_event*) cursor;
+                cursor += sizeof(inotify_event) + event->len;
+
+                const auto directory = m_directories.find(event->wd);
+                if (event->len == 0 || directory == m_directories.end())
+                {
+                    continue;
+                }
+
+                const std::string name = directory->second + event->name;
+                if (event->mask & IN_ISDIR)
+                {
+                    watch_tree(name + "/");
+                } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                {
+                    std::lock_guard lock{ m_mutex };
+                    m_pending[name] = now; // a later event pushes the deadline out
+                }
+            }
+        }
+    }
+}
+
+#else
+
+bool file_watcher::start(const std::string& directory, u32 debounce_ms)
+{
+    LOG_WARN("File watching is only implemented on Linux, not watching {}", directory);
+    return false;
+}
+
+void file_watcher::stop() {}
+
+void file_watcher::watch_tree(const std::string& relative) {}
+
+void file_watcher::run() {}
+
+#endif
+
+bool file_watcher::changes(std::vector<std::string>& out)
+{
+    const auto deadline = clock::now() - m_debounce;
+    const auto before   = out.size();
+
+    std::lock_guard lock{ m_mutex };
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if (it->second <= deadline)
+        {
+            out.emplace_back(it->first);
+            it = m_pending.erase(it);
+        } else
+        {
+            ++it;
+        }
+    }
+    return out.size() != before;
+}
+
+} // namespace blaze
@@ -0,0 +1,208 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+#include "Core/FrameLoop.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "Core/Logger.h"
+
+namespace blaze::loop
+{
+
+namespace
+{
+using clock = std::chrono::steady_clock;
+
+constexpr u32 sample_count   = 256;
+constexpr u32 stats_interval = 16; // percentiles are refreshed every this many frames
+
+settings          loop_settings{};
+stats             loop_stats{};
+bool              has_swap_control = true;
+clock::time_point frame_start{};
+f64               accumulator = 0.0;
+
+std::array<f64, sample_count> samples{};
+std::array<f64, sample_count> sorted_samples{};
+u32                           sample_index  = 0;
+u32                           samples_taken = 0;
+
+// Running estimate of how long a 1ms sleep actually takes on this machine. We sleep while the remaining
+// time is above mean + stddev and spin for the rest, so scheduler granularity doesn't turn into jitter.
+f64 sleep_estimate = 5e-3;
+f64 sleep_mean     = 5e-3;
+f64 sleep_m2       = 0.0;
+u64 sleep_count    = 1;
+
+f64 seconds_since(clock::time_point t)
+{
+    return std::chrono::duration<f64>(clock::now() - t).count();
+}
+
+void precise_sleep(f64 seconds)
+{
+    while (seconds > sleep_estimate)
+    {
+        const auto start = clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const f64 observed = seconds_since(start);
+        seconds -= observed;
+
+        // Welford's online variance
+        ++sleep_count;
+        const f64 delta = observed - sleep_mean;
+        sleep_mean += delta / (f64) sleep_count;
+        sleep_m2 += delta * (observed - sleep_mean);
+        sleep_estimate = sleep_mean + std::sqrt(sleep_m2 / (f64) (sleep_count - 1));
+    }
+
+    const auto spin_start = clock::now();
+    while (seconds_since(spin_start) < seconds)
+    {
+        std::this_thread::yield();
+    }
+}
+
+f64 percentile(u32 count, f64 p)
+{
+    const u32 n = std::min<u32>((u32) ((f64) count * p), count - 1);
+    std::nth_element(sorted_samples.begin(), sorted_samples.begin() + n, sorted_samples.begin() + count);
+    return sorted_samples[n];
+}
+
+void record_frame(f64 frame_ms)
+{
+    samples[sample_index] = frame_ms;
+    sample_index          = (sample_index + 1) % sample_count;
+    samples_taken         = std::min(samples_taken + 1, sample_count);
+    ++loop_stats.frame_count;
+
+    if (loop_stats.frame_count % stats_interval != 0)
+    {
+        return;
+    }
+
+    f64 total = 0.0;
+    for (u32 i = 0; i < samples_taken; ++i)
+    {
+        sorted_samples[i] = samples[i];
+        total += samples[i];
+    }
+    loop_stats.average_ms = total / (f64) samples_taken;
+    loop_stats.p50_ms     = percentile(samples_taken, 0.50);
+    loop_stats.p99_ms     = percentile(samples_taken, 0.99);
+}
+
+} // anonymous namespace
+
+void configure(const settings& s)
+{
+    loop_settings = s;
+    if (loop_settings.fixed_step <= 0.0)
+    {
+        LOG_WARN("Fixed step must be positive, using 1/60");
+        loop_settings.fixed_step = 1.0 / 60.0;
+    }
+    loop_settings.max_steps = std::max(loop_settings.max_steps, 1u);
+}
+
+const settings& current_settings()
+{
+    return loop_settings;
+}
+
+const stats& frame_stats()
+{
+    return loop_stats;
+}
+
+f64 delta_time()
+{
+    return loop_stats.delta;
+}
+
+f64 alpha()
+{
+    return loop_stats.alpha;
+}
+
+namespace detail
+{
+
+void start(bool swap_control)
+{
+    has_swap_control = swap_control;
+
+    frame_start   = clock::now();
+    accumulator   = 0.0;
+    sample_index  = 0;
+    samples_taken = 0;
+    loop_stats    = {};
+}
+
+u32 begin_frame()
+{
+    const auto now   = clock::now();
+    loop_stats.delta = std::chrono::duration<f64>(now - frame_start).count();
+    frame_start      = now;
+
+    // Anything past max_steps is dropped, the simulation slows down instead of falling further behind
+    accumulator += std::min(loop_stats.delta, loop_settings.fixed_step * loop_settings.max_steps);
+    const u32 steps = (u32) (accumulator / loop_settings.fixed_step);
+    accumulator -= steps * loop_settings.fixed_step;
+    loop_stats.alpha = accumulator / loop_settings.fixed_step;
+    return steps;
+}
+
+void end_frame()
+{
+    if (loop_settings.target_fps > 0.0)
+    {
+        const f64 remaining = 1.0 / loop_settings.target_fps - seconds_since(frame_start);
+        if (remaining > 0.0)
+        {
+            precise_sleep(remaining);
+        }
+    }
+
+    record_frame(seconds_since(frame_start) * 1000.0);
+}
+
+i32 swap_interval()
+{
+    if (!has_swap_control)
+    {
+        return 0;
+    }
+    switch (loop_settings.vsync)
+    {
+    case vsync_mode::off: return 0;
+    case vsync_mode::on: return 1;
+    case vsync_mode::adaptive: return -1;
+    }
+    return 1;
+}
+
+} // namespace detail
+
+} // namespace blaze::loop
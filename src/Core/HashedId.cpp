@@ -0,0 +1,68 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+#include "Core/HashedId.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Core/Logger.h"
+
+namespace blaze
+{
+
+namespace
+{
+struct name_table
+{
+    std::mutex                           mutex{};
+    std::unordered_map<u64, std::string> names{}; // node based, views into the strings stay valid
+};
+
+// Function local so ids built during static initialization can register
+name_table& names()
+{
+    static name_table table;
+    return table;
+}
+} // anonymous namespace
+
+hashed_id intern(std::string_view name)
+{
+    const hashed_id id{ name };
+    name_table&     table = names();
+
+    std::lock_guard lock{ table.mutex };
+    const auto [it, inserted] = table.names.try_emplace(id.value(), name);
+    if (!inserted && it->second != name)
+    {
+        LOG_ERROR("Hash collision: [{}] and [{}] are both {:#018x}", it->second, name, id.value());
+    }
+    return id;
+}
+
+std::string_view name_of(hashed_id id)
+{
+    name_table&     table = names();
+    std::lock_guard lock{ table.mutex };
+    const auto      it = table.names.find(id.value());
+    return it != table.names.end() ? std::string_view{ it->second } : std::string_view{};
+}
+
+} // namespace blaze
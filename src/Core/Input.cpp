@@ -0,0 +1,358 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+#include "Core/Input.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <SDL.h>
+
+#include "Core/Logger.h"
+#include "Core/SpscQueue.h"
+
+namespace blaze::input
+{
+
+namespace
+{
+constexpr f64 latency_smoothing = 0.05;
+
+struct gamepad_slot
+{
+    SDL_GameController* controller{ nullptr };
+    SDL_JoystickID      instance_id{ -1 };
+};
+
+// Single writer seqlock. The payload is kept as relaxed atomic words so a reader overlapping a write only ever sees a
+// torn copy it then throws away, never a data race. Readers don't lock and don't block the writer
+template<typename T>
+class seqlock_value
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    static constexpr u32 word_count = (u32) ((sizeof(T) + sizeof(u64) - 1) / sizeof(u64));
+
+public:
+    void store(const T& value)
+    {
+        std::array<u64, word_count> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const u32 seq = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (u32 i = 0; i < word_count; ++i)
+        {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+        m_sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const
+    {
+        std::array<u64, word_count> words;
+        u32                         before;
+        u32                         after;
+        do
+        {
+            before = m_sequence.load(std::memory_order_acquire);
+            for (u32 i = 0; i < word_count; ++i)
+            {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_sequence.load(std::memory_order_relaxed);
+        } while ((before & 1u) || before != after);
+
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    std::atomic<u32>                         m_sequence{ 0 }; // odd while being written
+    std::array<std::atomic<u64>, word_count> m_words{};
+};
+
+bool                                   is_init = false;
+spsc_queue<event, 1024>                queue{};
+std::array<gamepad_slot, max_gamepads> pads{};
+latency_stats                          latency_info{};
+state                                  building{};
+u64                                    frame_count     = 0;
+u64                                    oldest_in_frame = 0; // SDL ticks of the oldest event pumped this frame, 0 if none
+
+// What other threads see, written once a frame by the event thread
+seqlock_value<state>         published{};
+seqlock_value<latency_stats> published_latency{};
+
+i32 find_pad(SDL_JoystickID id)
+{
+    for (u32 i = 0; i < max_gamepads; ++i)
+    {
+        if (pads[i].controller && pads[i].instance_id == id)
+        {
+            return (i32) i;
+        }
+    }
+    return -1;
+}
+
+i32 open_pad(i32 device_index)
+{
+    for (u32 i = 0; i < max_gamepads; ++i)
+    {
+        if (!pads[i].controller)
+        {
+            SDL_GameController* controller = SDL_GameControllerOpen(device_index);
+            if (!controller)
+            {
+                LOG_WARN("Failed to open gamepad {}: {}", device_index, SDL_GetError());
+                return -1;
+            }
+            pads[i].controller  = controller;
+            pads[i].instance_id = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controller));
+            return (i32) i;
+        }
+    }
+    LOG_WARN("Ignoring gamepad {}, all {} slots are in use", device_index, max_gamepads);
+    return -1;
+}
+
+void close_pad(u32 slot)
+{
+    SDL_GameControllerClose(pads[slot].controller);
+    pads[slot]              = {};
+    building.gamepads[slot] = {};
+}
+
+void publish(const event& e)
+{
+    if (!queue.push(e))
+    {
+        ++latency_info.dropped_events;
+    }
+}
+
+void set_bit(u32& bits, u32 bit, bool value)
+{
+    bits = value ? (bits | (1u << bit)) : (bits & ~(1u << bit));
+}
+
+} // anonymous namespace
+
+bool poll(event& out)
+{
+    return queue.pop(out);
+}
+
+state snapshot()
+{
+    return published.load();
+}
+
+latency_stats latency()
+{
+    return published_latency.load();
+}
+
+namespace detail
+{
+
+bool init()
+{
+    if (is_init)
+    {
+        return false;
+    }
+    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER))
+    {
+        LOG_WARN("Gamepad support unavailable: {}", SDL_GetError());
+    }
+    building = {};
+    is_init  = true;
+    return true;
+}
+
+void shutdown()
+{
+    if (!is_init)
+    {
+        return;
+    }
+    for (u32 i = 0; i < max_gamepads; ++i)
+    {
+        if (pads[i].controller)
+        {
+            close_pad(i);
+        }
+    }
+    is_init = false;
+}
+
+void begin_frame()
+{
+    building.mouse_dx = 0;
+    building.mouse_dy = 0;
+    building.wheel_x  = 0;
+    building.wheel_y  = 0;
+}
+
+void process(const SDL_Event& e)
+{
+    event ev{};
+    ev.timestamp = e.common.timestamp;
+
+    switch (e.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+    {
+        if (e.key.repeat || (u32) e.key.keysym.scancode >= max_keys)
+        {
+            return;
+        }
+        const bool down = e.type == SDL_KEYDOWN;
+        building.keys.set((u32) e.key.keysym.scancode, down);
+        ev.type      = down ? event_type::key_down : event_type::key_up;
+        ev.code      = (u16) e.key.keysym.scancode;
+        ev.window_id = e.key.windowID;
+        break;
+    }
+    case SDL_MOUSEMOTION:
+        building.mouse_x = e.motion.x;
+        building.mouse_y = e.motion.y;
+        building.mouse_dx += e.motion.xrel;
+        building.mouse_dy += e.motion.yrel;
+        ev.type      = event_type::mouse_move;
+        ev.x         = e.motion.x;
+        ev.y         = e.motion.y;
+        ev.window_id = e.motion.windowID;
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+    {
+        const bool down = e.type == SDL_MOUSEBUTTONDOWN;
+        set_bit(building.mouse_buttons, e.button.button, down);
+        ev.type      = down ? event_type::mouse_down : event_type::mouse_up;
+        ev.code      = e.button.button;
+        ev.x         = e.button.x;
+        ev.y         = e.button.y;
+        ev.window_id = e.button.windowID;
+        break;
+    }
+    case SDL_MOUSEWHEEL:
+        building.wheel_x += e.wheel.x;
+        building.wheel_y += e.wheel.y;
+        ev.type      = event_type::mouse_wheel;
+        ev.x         = e.wheel.x;
+        ev.y         = e.wheel.y;
+        ev.window_id = e.wheel.windowID;
+        break;
+    case SDL_CONTROLLERDEVICEADDED:
+    {
+        const i32 slot = open_pad(e.cdevice.which);
+        if (slot < 0)
+        {
+            return;
+        }
+        building.gamepads[slot].connected = true;
+        ev.type                           = event_type::gamepad_added;
+        ev.device                         = (u8) slot;
+        break;
+    }
+    case SDL_CONTROLLERDEVICEREMOVED:
+    {
+        const i32 slot = find_pad(e.cdevice.which);
+        if (slot < 0)
+        {
+            return;
+        }
+        close_pad((u32) slot);
+        ev.type   = event_type::gamepad_removed;
+        ev.device = (u8) slot;
+        break;
+    }
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+    {
+        const i32 slot = find_pad(e.cbutton.which);
+        if (slot < 0)
+        {
+            return;
+        }
+        const bool down = e.type == SDL_CONTROLLERBUTTONDOWN;
+        set_bit(building.gamepads[slot].buttons, e.cbutton.button, down);
+        ev.type   = down ? event_type::gamepad_down : event_type::gamepad_up;
+        ev.device = (u8) slot;
+        ev.code   = e.cbutton.button;
+        break;
+    }
+    case SDL_CONTROLLERAXISMOTION:
+    {
+        const i32 slot = find_pad(e.caxis.which);
+        if (slot < 0 || e.caxis.axis >= max_gamepad_axes)
+        {
+            return;
+        }
+        building.gamepads[slot].axes[e.caxis.axis] = e.caxis.value;
+        ev.type                                    = event_type::gamepad_axis;
+        ev.device                                  = (u8) slot;
+        ev.code                                    = e.caxis.axis;
+        ev.x                                       = e.caxis.value;
+        break;
+    }
+    default: return;
+    }
+
+    if (oldest_in_frame == 0 || ev.timestamp < oldest_in_frame)
+    {
+        oldest_in_frame = ev.timestamp;
+    }
+    publish(ev);
+}
+
+void end_frame()
+{
+    building.frame     = ++frame_count;
+    building.timestamp = SDL_GetTicks64();
+
+    published.store(building);
+}
+
+void frame_presented()
+{
+    if (oldest_in_frame == 0)
+    {
+        latency_info.last_frame_max_ms = 0.0;
+        published_latency.store(latency_info);
+        return;
+    }
+
+    // SDL event timestamps are 32-bit milliseconds, only the low bits of the 64-bit tick count are comparable
+    const f64 ms = (f64) (u32) ((u32) SDL_GetTicks64() - (u32) oldest_in_frame);
+    latency_info.last_frame_max_ms = ms;
+    latency_info.average_ms += (ms - latency_info.average_ms) * latency_smoothing;
+    oldest_in_frame = 0;
+    published_latency.store(latency_info);
+}
+
+} // namespace detail
+
+} // namespace blaze::input
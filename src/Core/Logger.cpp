@@ -18,32 +18,28 @@
 //  ------------------------------------------------------------------------------
 #include "Core/Logger.h"
 
+#include <cstdio>
+#include <ctime>
+
 namespace blaze::logger::detail
 {
 
 namespace
 {
-std::string current_time_stamp()
-{
-    time_t now = time(nullptr);
-    tm*    ltm = localtime(&now);
-    return std::format("{:02}:{:02}:{:02}", ltm->tm_hour, ltm->tm_min, ltm->tm_sec);
-}
+constexpr const char* level_tags[] = { "  TRACE  ", "  DEBUG  ", "  INFO   ", " WARNING ", "  ERROR  ", "  FATAL  " };
 } // anonymous namespace
+
 void output(log_level lvl, std::string_view msg)
 {
-    std::string str;
-    std::string time_stamp = current_time_stamp();
-    switch (lvl)
-    {
-    case log_level::trace: str = std::format("[{}][  TRACE  ]: {}\n", time_stamp, msg); break;
-    case log_level::debug: str = std::format("[{}][  DEBUG  ]: {}\n", time_stamp, msg); break;
-    case log_level::info: str = std::format("[{}][  INFO   ]: {}\n", time_stamp, msg); break;
-    case log_level::warn: str = std::format("[{}][ WARNING ]: {}\n", time_stamp, msg); break;
-    case log_level::error: str = std::format("[{}][  ERROR  ]: {}\n", time_stamp, msg); break;
-    case log_level::fatal: str = std::format("[{}][  FATAL  ]: {}\n", time_stamp, msg); break;
-    }
+    // Reused like the message buffer in format(), a log line doesn't allocate once the buffer has grown
+    thread_local std::string line;
+
+    time_t now = time(nullptr);
+    tm*    ltm = localtime(&now);
+    line.clear();
+    std::format_to(std::back_inserter(line), "[{:02}:{:02}:{:02}][{}]: {}\n", ltm->tm_hour, ltm->tm_min, ltm->tm_sec,
+                   level_tags[(u32) lvl], msg);
 
-    printf("%s", str.c_str());
+    fwrite(line.data(), 1, line.size(), stdout);
 }
 } // namespace blaze::logger::detail
\ No newline at end of file
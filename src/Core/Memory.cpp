@@ -0,0 +1,219 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#include "Core/Memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+#include "Core/Logger.h"
+
+namespace blaze::memory
+{
+
+namespace
+{
+struct counter
+{
+    std::atomic<u64> allocations{};
+    std::atomic<u64> frees{};
+    std::atomic<u64> live_bytes{};
+    std::atomic<u64> peak_bytes{};
+};
+
+counter          counters[(u32) subsystem::count]{};
+std::atomic<u64> global_allocations{};
+u64              frame_start_allocations{};
+frame_stats      previous{};
+
+constexpr const char* subsystem_names[(u32) subsystem::count] = { "general", "core", "graphics", "text" };
+
+u64 align_up(u64 value, u64 alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+} // anonymous namespace
+
+void record_allocation(subsystem tag, u64 bytes)
+{
+    counter& c = counters[(u32) tag];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    const u64 live = c.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    u64       peak = c.peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+}
+
+void record_free(subsystem tag, u64 bytes)
+{
+    counter& c = counters[(u32) tag];
+    c.frees.fetch_add(1, std::memory_order_relaxed);
+    c.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+usage subsystem_usage(subsystem tag)
+{
+    const counter& c = counters[(u32) tag];
+    return { c.allocations.load(std::memory_order_relaxed), c.frees.load(std::memory_order_relaxed),
+             c.live_bytes.load(std::memory_order_relaxed), c.peak_bytes.load(std::memory_order_relaxed) };
+}
+
+const char* subsystem_name(subsystem tag)
+{
+    return tag < subsystem::count ? subsystem_names[(u32) tag] : "unknown";
+}
+
+linear_arena::linear_arena(u64 capacity, subsystem tag) : m_capacity(capacity), m_tag(tag)
+{
+    m_base = (u8*) ::operator new(m_capacity);
+    record_allocation(m_tag, m_capacity);
+}
+
+linear_arena::~linear_arena()
+{
+    reset();
+    ::operator delete(m_base);
+    record_free(m_tag, m_capacity);
+}
+
+void* linear_arena::allocate(u64 size, u64 alignment)
+{
+    // Aligned by address rather than offset so alignments above the block's own work too
+    const auto base    = (u64) m_base;
+    const u64  aligned = align_up(base + m_offset, alignment) - base;
+    if (aligned + size <= m_capacity)
+    {
+        m_offset     = aligned + size;
+        m_high_water = std::max(m_high_water, used());
+        return m_base + aligned;
+    }
+
+    // Over allocated by the alignment so the block can be freed as allocated
+    const u64 block_size = size + alignment;
+    u8*       block      = (u8*) ::operator new(block_size);
+    record_allocation(m_tag, block_size);
+    m_overflow.emplace_back(block);
+    m_overflow_bytes += block_size;
+    m_high_water = std::max(m_high_water, used());
+    return (void*) align_up((u64) block, alignment);
+}
+
+void linear_arena::reset()
+{
+    if (!m_overflow.empty())
+    {
+        for (u8* block : m_overflow)
+        {
+            ::operator delete(block);
+        }
+        record_free(m_tag, m_overflow_bytes);
+        m_overflow.clear();
+
+        // Grow so the same load fits next time, with headroom for alignment padding
+        ::operator delete(m_base);
+        record_free(m_tag, m_capacity);
+        m_capacity = align_up(m_high_water + m_high_water / 4, 4096);
+        m_base     = (u8*) ::operator new(m_capacity);
+        record_allocation(m_tag, m_capacity);
+        LOG_DEBUG("Frame arena grew to {}KB", m_capacity / 1024);
+    }
+    m_offset         = 0;
+    m_overflow_bytes = 0;
+}
+
+linear_arena& frame_arena()
+{
+    thread_local linear_arena arena{};
+    return arena;
+}
+
+const frame_stats& last_frame()
+{
+    return previous;
+}
+
+bool heap_tracking()
+{
+#ifdef BLAZE_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+u64 heap_allocations()
+{
+    return global_allocations.load(std::memory_order_relaxed);
+}
+
+namespace detail
+{
+void end_frame()
+{
+    const u64 total           = heap_allocations();
+    previous.heap_allocations = total - frame_start_allocations;
+    previous.arena_bytes      = frame_arena().used();
+    frame_arena().reset();
+    // After the reset, so an arena growing counts against the frame that overflowed it
+    frame_start_allocations = heap_allocations();
+}
+} // namespace detail
+
+} // namespace blaze::memory
+
+#ifdef BLAZE_TRACK_ALLOCATIONS
+// Replaces the global allocation functions to count every heap allocation in the process. The nothrow forms forward
+// here in libstdc++ and libc++, over-aligned allocations aren't counted
+void* operator new(size_t size)
+{
+    blaze::memory::global_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new[](size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+#endif
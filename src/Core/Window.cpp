@@ -19,14 +19,42 @@
 #include "Core/Window.h"
 
 #include "Graphics/GLCore.h"
+#include "Graphics/EglContext.h"
+#include "Graphics/DeletionQueue.h"
+#include "Core/Logger.h"
 #include <SDL.h>
+#include <GL/glew.h>
 
 namespace blaze
 {
 
 namespace
 {
-bool is_init = false;
+bool    is_init      = false;
+backend active_mode  = backend::windowed;
+u32     offscreen_id = 0; // headless windows have no SDL ID, hand out our own
+// Every window renders through this one context, so GL objects are created once and usable from any window.
+// Switching windows only rebinds the drawable. The context lives on a hidden window no caller can close, destroying
+// the current window would otherwise leave nothing current for the GL objects still to be released
+SDL_GLContext shared_context  = nullptr;
+SDL_Window*   context_window  = nullptr;
+SDL_Window*   current_surface = nullptr;
+
+void shutdown_graphics_context()
+{
+    if (shared_context)
+    {
+        SDL_GL_DeleteContext(shared_context);
+        shared_context = nullptr;
+    }
+    if (context_window)
+    {
+        SDL_DestroyWindow(context_window);
+        context_window = nullptr;
+    }
+    current_surface = nullptr;
+    SDL_Quit();
+}
 } // anonymous namespace
 
 bool window::create(const std::string& title, i32 width, i32 height)
@@ -36,6 +64,13 @@ bool window::create(const std::string& title, i32 width, i32 height)
         return false;
     }
 
+    m_width  = width;
+    m_height = height;
+    if (active_mode == backend::headless)
+    {
+        return create_offscreen();
+    }
+
     m_window = SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_OPENGL);
     if (!m_window)
     {
@@ -43,22 +78,48 @@ bool window::create(const std::string& title, i32 width, i32 height)
         return false;
     }
 
-    m_context = SDL_GL_CreateContext(m_window);
-    if (!m_context)
+    m_id    = SDL_GetWindowID(m_window);
+    m_alive = true;
+    return true;
+}
+
+bool window::create_offscreen()
+{
+    glGenTextures(1, &m_color);
+    glBindTexture(GL_TEXTURE_2D, m_color);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, m_width, m_height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &m_depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depth);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
     {
-        // TODO: Log error
+        LOG_ERROR("Offscreen framebuffer incomplete: 0x{:x}", status);
+        m_alive = true;
+        destroy();
         return false;
     }
 
-    gfx::init();
-
+    m_id    = ++offscreen_id;
     m_alive = true;
     return true;
 }
 
 void window::swap()
 {
-    if (!is_init)
+    if (!is_init || m_framebuffer)
     {
         return;
     }
@@ -73,7 +134,21 @@ void window::destroy()
         return;
     }
 
-    SDL_GL_DeleteContext(m_context);
+    if (m_framebuffer || m_color)
+    {
+        gfx::deletion::retire(gfx::gl_object::framebuffer, m_framebuffer);
+        gfx::deletion::retire(gfx::gl_object::texture, m_color, (u64) m_width * m_height * 4);
+        gfx::deletion::retire(gfx::gl_object::renderbuffer, m_depth, (u64) m_width * m_height * 4);
+        m_framebuffer = m_color = m_depth = 0;
+        m_alive                           = false;
+        return;
+    }
+
+    if (current_surface == m_window)
+    {
+        SDL_GL_MakeCurrent(context_window, shared_context);
+        current_surface = context_window;
+    }
     SDL_DestroyWindow(m_window);
     m_alive = false;
 }
@@ -84,12 +159,89 @@ SDL_Window* window::handle() const
 
 void window::activate()
 {
-    SDL_GL_MakeCurrent(m_window, m_context);
+    if (m_framebuffer)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glViewport(0, 0, m_width, m_height);
+        return;
+    }
+
+    if (current_surface != m_window)
+    {
+        SDL_GL_MakeCurrent(m_window, shared_context);
+        current_surface = m_window;
+    }
+    // The viewport belongs to the shared context, it still holds the size of whatever was drawn last
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, m_width, m_height);
+    if (m_interval_dirty)
+    {
+        apply_swap_interval();
+    }
 }
 
+void window::resized(i32 width, i32 height)
+{
+    m_width  = width;
+    m_height = height;
+    if (!m_framebuffer && current_surface == m_window)
+    {
+        glViewport(0, 0, m_width, m_height);
+    }
+}
+
+void window::set_swap_interval(i32 interval)
+{
+    if (interval == m_swap_interval && !m_interval_dirty)
+    {
+        return;
+    }
+    m_swap_interval  = interval;
+    m_interval_dirty = true;
+    if (!m_framebuffer && current_surface == m_window)
+    {
+        apply_swap_interval();
+    }
+}
 
-bool init_graphics()
+void window::apply_swap_interval()
 {
+    m_interval_dirty = false;
+    if (SDL_GL_SetSwapInterval(m_swap_interval) == 0)
+    {
+        return;
+    }
+
+    if (m_swap_interval == -1)
+    {
+        LOG_WARN("Adaptive vsync not supported, falling back to vsync on");
+        if (SDL_GL_SetSwapInterval(1) == 0)
+        {
+            return;
+        }
+    }
+    LOG_ERROR("Failed to set swap interval: {}", SDL_GetError());
+}
+
+
+bool init_graphics(backend mode)
+{
+    if (mode == backend::headless)
+    {
+        if (!gfx::egl::create_context())
+        {
+            return false;
+        }
+        if (!gfx::init(gfx::egl::get_proc_address))
+        {
+            gfx::egl::destroy_context();
+            return false;
+        }
+        active_mode = mode;
+        is_init     = true;
+        return true;
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO))
     {
         // TODO: Log error
@@ -110,7 +262,24 @@ bool init_graphics()
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
     SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
 
-    is_init = true;
+    context_window = SDL_CreateWindow("blaze", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 1, 1,
+                                      SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    shared_context = context_window ? SDL_GL_CreateContext(context_window) : nullptr;
+    if (!shared_context)
+    {
+        LOG_ERROR("Failed to create the GL context: {}", SDL_GetError());
+        shutdown_graphics_context();
+        return false;
+    }
+    current_surface = context_window;
+    if (!gfx::init(SDL_GL_GetProcAddress))
+    {
+        shutdown_graphics_context();
+        return false;
+    }
+
+    active_mode = mode;
+    is_init     = true;
     return true;
 }
 
@@ -120,8 +289,19 @@ void shutdown_graphics()
     {
         return;
     }
-    SDL_Quit();
+    if (active_mode == backend::headless)
+    {
+        gfx::egl::destroy_context();
+        is_init = false;
+        return;
+    }
+    shutdown_graphics_context();
     is_init = false;
 }
 
+backend graphics_backend()
+{
+    return active_mode;
+}
+
 } // namespace blaze
\ No newline at end of file
@@ -0,0 +1,130 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+#include "Core/WindowRegistry.h"
+
+#include "Core/Logger.h"
+
+namespace blaze
+{
+
+window_handle window_registry::create(const std::string& title, i32 width, i32 height)
+{
+    const hashed_id id = intern(title);
+    if (m_titles.contains(id))
+    {
+        LOG_ERROR("A window titled [{}] already exists", title);
+        return {};
+    }
+
+    window wnd{};
+    if (!wnd.create(title, width, height))
+    {
+        return {};
+    }
+
+    u32 index;
+    if (!m_free_slots.empty())
+    {
+        index = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else
+    {
+        index = (u32) m_slots.size();
+        m_slots.emplace_back();
+    }
+
+    slot& s = m_slots[index];
+    s.wnd   = wnd;
+    s.title = id;
+    s.used  = true;
+
+    const window_handle handle{ index, s.generation };
+    m_sdl_ids.emplace(wnd.id(), handle);
+    m_titles.emplace(id, handle);
+    return handle;
+}
+
+void window_registry::destroy(window_handle handle)
+{
+    window* wnd = get(handle);
+    if (!wnd)
+    {
+        return;
+    }
+
+    slot& s = m_slots[handle.index];
+    m_sdl_ids.erase(wnd->id());
+    m_titles.erase(s.title);
+    wnd->destroy();
+
+    s.wnd   = {};
+    s.used  = false;
+    s.title = {};
+    ++s.generation;
+    m_free_slots.push_back(handle.index);
+}
+
+void window_registry::clear()
+{
+    for (auto& s : m_slots)
+    {
+        if (s.used)
+        {
+            s.wnd.destroy();
+        }
+    }
+    m_slots.clear();
+    m_free_slots.clear();
+    m_sdl_ids.clear();
+    m_titles.clear();
+}
+
+window* window_registry::get(window_handle handle)
+{
+    if (handle.index >= m_slots.size())
+    {
+        return nullptr;
+    }
+    slot& s = m_slots[handle.index];
+    return (s.used && s.generation == handle.generation) ? &s.wnd : nullptr;
+}
+
+const window* window_registry::get(window_handle handle) const
+{
+    return const_cast<window_registry*>(this)->get(handle);
+}
+
+window_handle window_registry::find(hashed_id title) const
+{
+    auto it = m_titles.find(title);
+    return it != m_titles.end() ? it->second : window_handle{};
+}
+
+window_handle window_registry::find(const std::string& title) const
+{
+    return find(hashed_id{ title });
+}
+
+window_handle window_registry::from_sdl_id(u32 id) const
+{
+    auto it = m_sdl_ids.find(id);
+    return it != m_sdl_ids.end() ? it->second : window_handle{};
+}
+
+} // namespace blaze
@@ -0,0 +1,368 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+#include "Graphics/ClusteredLighting.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <GL/glew.h>
+
+#include "Graphics/DeletionQueue.h"
+#include "Graphics/ShaderLibrary.h"
+#include "Core/Logger.h"
+
+namespace blaze::gfx
+{
+
+namespace
+{
+constexpr u32 assign_shared_capacity  = 4096; // cluster_assign.cs shared list, 16KB of the 32KB GL guarantees
+constexpr u32 cluster_bounds_binding  = 6;
+constexpr u32 cluster_counter_binding = 7;
+
+u32 create_storage(u64 size)
+{
+    u32 buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr) size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return buffer;
+}
+
+// Orphans the old contents first so the driver doesn't sync with draws still reading last frame's data
+void upload(u32 buffer, const void* data, u64 size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    glInvalidateBufferData(buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, (GLsizeiptr) size, data);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// Squared distance from v to the [lo, hi] interval
+f32 distance_sq(f32 v, f32 lo, f32 hi)
+{
+    const f32 d = std::max(std::max(lo - v, 0.0f), v - hi);
+    return d * d;
+}
+} // anonymous namespace
+
+clustered_lighting::~clustered_lighting()
+{
+    destroy();
+}
+
+bool clustered_lighting::create(const cluster_settings& settings)
+{
+    destroy();
+    m_settings = settings;
+    if (m_settings.assignment == light_assignment::gpu)
+    {
+        if (m_settings.max_lights_per_cluster > assign_shared_capacity)
+        {
+            LOG_WARN("GPU light assignment holds at most {} lights per cluster", assign_shared_capacity);
+            m_settings.max_lights_per_cluster = assign_shared_capacity;
+        }
+        // The shared memory list is sized to the setting, not the worst case
+        m_assign = shaders().get_compute(
+            "cluster_assign",
+            define_set{ { "MAX_LIGHTS_PER_CLUSTER", std::to_string(m_settings.max_lights_per_cluster) } });
+        if (!m_assign)
+        {
+            return false;
+        }
+    }
+
+    const u32 clusters = cluster_count();
+    m_counts.resize(clusters);
+    m_grid.resize(clusters * 2);
+    m_indices.reserve(m_settings.max_indices);
+    m_column_d2.resize(m_settings.tiles_x);
+    m_row_d2.resize(m_settings.tiles_y);
+
+    m_lights_buffer  = create_storage((u64) m_settings.max_lights * sizeof(light));
+    m_grid_buffer    = create_storage((u64) clusters * 2 * sizeof(u32));
+    m_indices_buffer = create_storage((u64) m_settings.max_indices * sizeof(u32));
+    if (m_settings.assignment == light_assignment::gpu)
+    {
+        m_bounds_buffer  = create_storage((u64) clusters * 8 * sizeof(f32));
+        m_counter_buffer = create_storage(sizeof(u32));
+    }
+    return true;
+}
+
+void clustered_lighting::destroy()
+{
+    for (u32* buffer : { &m_lights_buffer, &m_grid_buffer, &m_indices_buffer, &m_bounds_buffer, &m_counter_buffer })
+    {
+        deletion::retire(gl_object::buffer, *buffer);
+        *buffer = 0;
+    }
+    m_assign = nullptr;
+}
+
+void clustered_lighting::set_projection(f32 fov_y, f32 aspect, f32 near_plane, f32 far_plane, i32 screen_width,
+                                        i32 screen_height)
+{
+    const u32 tx = m_settings.tiles_x;
+    const u32 ty = m_settings.tiles_y;
+    const u32 tz = m_settings.slices;
+
+    m_near          = near_plane;
+    m_far           = far_plane;
+    m_screen_width  = screen_width;
+    m_screen_height = screen_height;
+
+    const f32 log_ratio = std::log(far_plane / near_plane);
+    m_z_scale           = (f32) tz / log_ratio;
+    m_z_bias            = -(f32) tz * std::log(near_plane) / log_ratio;
+
+    const f32 tan_y = std::tan(fov_y * 0.5f);
+    const f32 tan_x = tan_y * aspect;
+
+    m_slice_near.resize(tz);
+    m_slice_far.resize(tz);
+    m_column_min.resize(tz * tx);
+    m_column_max.resize(tz * tx);
+    m_row_min.resize(tz * ty);
+    m_row_max.resize(tz * ty);
+
+    // Extent of an NDC range over the slice's depth range, the tile's frustum widens with depth
+    auto extent = [](f32 ndc0, f32 ndc1, f32 tan_half, f32 d0, f32 d1, f32& lo, f32& hi) {
+        const f32 v[4] = { ndc0 * tan_half * d0, ndc0 * tan_half * d1, ndc1 * tan_half * d0, ndc1 * tan_half * d1 };
+        lo             = std::min({ v[0], v[1], v[2], v[3] });
+        hi             = std::max({ v[0], v[1], v[2], v[3] });
+    };
+
+    for (u32 k = 0; k < tz; ++k)
+    {
+        const f32 d0    = near_plane * std::pow(far_plane / near_plane, (f32) k / (f32) tz);
+        const f32 d1    = near_plane * std::pow(far_plane / near_plane, (f32) (k + 1) / (f32) tz);
+        m_slice_near[k] = d0;
+        m_slice_far[k]  = d1;
+
+        for (u32 i = 0; i < tx; ++i)
+        {
+            extent(-1.0f + 2.0f * (f32) i / (f32) tx, -1.0f + 2.0f * (f32) (i + 1) / (f32) tx, tan_x, d0, d1,
+                   m_column_min[k * tx + i], m_column_max[k * tx + i]);
+        }
+        for (u32 j = 0; j < ty; ++j)
+        {
+            extent(-1.0f + 2.0f * (f32) j / (f32) ty, -1.0f + 2.0f * (f32) (j + 1) / (f32) ty, tan_y, d0, d1,
+                   m_row_min[k * ty + j], m_row_max[k * ty + j]);
+        }
+    }
+
+    if (m_bounds_buffer)
+    {
+        std::vector<f32> bounds(cluster_count() * 8);
+        for (u32 k = 0; k < tz; ++k)
+        {
+            for (u32 j = 0; j < ty; ++j)
+            {
+                for (u32 i = 0; i < tx; ++i)
+                {
+                    f32* b = &bounds[((k * ty + j) * tx + i) * 8];
+                    b[0]   = m_column_min[k * tx + i];
+                    b[1]   = m_row_min[k * ty + j];
+                    b[2]   = -m_slice_far[k];
+                    b[4]   = m_column_max[k * tx + i];
+                    b[5]   = m_row_max[k * ty + j];
+                    b[6]   = -m_slice_near[k];
+                }
+            }
+        }
+        upload(m_bounds_buffer, bounds.data(), bounds.size() * sizeof(f32));
+    }
+}
+
+u32 clustered_lighting::slice_of(f32 depth) const
+{
+    const f32 slice = std::log(depth) * m_z_scale + m_z_bias;
+    return std::min((u32) std::max(slice, 0.0f), m_settings.slices - 1);
+}
+
+void clustered_lighting::update(std::span<const light> lights)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const u32 light_count = (u32) std::min<u64>(lights.size(), m_settings.max_lights);
+    if (light_count < lights.size())
+    {
+        LOG_WARN("Clustered lighting got {} lights, only the first {} are used", lights.size(), light_count);
+    }
+    lights = lights.first(light_count);
+
+    m_stats             = {};
+    m_stats.light_count = light_count;
+    upload(m_lights_buffer, lights.data(), lights.size_bytes());
+
+    if (m_settings.assignment == light_assignment::gpu)
+    {
+        assign_gpu(light_count);
+    } else
+    {
+        assign_cpu(lights);
+    }
+
+    m_stats.assign_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void clustered_lighting::assign_cpu(std::span<const light> lights)
+{
+    const u32 tx = m_settings.tiles_x;
+    const u32 ty = m_settings.tiles_y;
+
+    std::fill(m_counts.begin(), m_counts.end(), 0u);
+    m_pairs.clear();
+
+    // Per light: find the slices its depth range covers, then per slice test every column and row against the sphere
+    // separately. Those loops are branchless over contiguous arrays so the compiler vectorises them, and only the
+    // tiles where both axes pass get the full sphere/AABB distance check.
+    f32* column_d2 = m_column_d2.data();
+    f32* row_d2    = m_row_d2.data();
+    for (u32 l = 0; l < (u32) lights.size(); ++l)
+    {
+        const light& lt     = lights[l];
+        const f32    x      = lt.position[0];
+        const f32    y      = lt.position[1];
+        const f32    depth  = -lt.position[2];
+        const f32    radius = lt.radius;
+        if (depth + radius < m_near || depth - radius > m_far)
+        {
+            continue;
+        }
+
+        const u32 first_slice = slice_of(std::max(depth - radius, m_near));
+        const u32 last_slice  = slice_of(std::min(depth + radius, m_far));
+        for (u32 k = first_slice; k <= last_slice; ++k)
+        {
+            const f32 budget = radius * radius - distance_sq(depth, m_slice_near[k], m_slice_far[k]);
+            if (budget < 0.0f)
+            {
+                continue;
+            }
+
+            const f32* column_min = &m_column_min[k * tx];
+            const f32* column_max = &m_column_max[k * tx];
+            for (u32 i = 0; i < tx; ++i)
+            {
+                column_d2[i] = distance_sq(x, column_min[i], column_max[i]);
+            }
+            const f32* row_min = &m_row_min[k * ty];
+            const f32* row_max = &m_row_max[k * ty];
+            for (u32 j = 0; j < ty; ++j)
+            {
+                row_d2[j] = distance_sq(y, row_min[j], row_max[j]);
+            }
+
+            for (u32 j = 0; j < ty; ++j)
+            {
+                if (row_d2[j] > budget)
+                {
+                    continue;
+                }
+                for (u32 i = 0; i < tx; ++i)
+                {
+                    if (column_d2[i] + row_d2[j] <= budget)
+                    {
+                        const u32 cluster = (k * ty + j) * tx + i;
+                        ++m_counts[cluster];
+                        m_pairs.push_back(cluster);
+                        m_pairs.push_back(l);
+                    }
+                }
+            }
+        }
+    }
+
+    // Prefix sum into offsets, capping each cluster and the total
+    u32 offset = 0;
+    for (u32 c = 0; c < cluster_count(); ++c)
+    {
+        u32 count = std::min(m_counts[c], m_settings.max_lights_per_cluster);
+        count     = std::min(count, m_settings.max_indices - offset);
+        m_stats.overflowed += m_counts[c] - count;
+        m_grid[c * 2]     = offset;
+        m_grid[c * 2 + 1] = count;
+        m_counts[c]       = 0; // reused as the fill cursor
+        offset += count;
+    }
+
+    // Pairs are in light order, so every cluster's list comes out sorted
+    m_indices.resize(offset);
+    for (u64 p = 0; p < m_pairs.size(); p += 2)
+    {
+        const u32 cluster = m_pairs[p];
+        u32&      cursor  = m_counts[cluster];
+        if (cursor < m_grid[cluster * 2 + 1])
+        {
+            m_indices[m_grid[cluster * 2] + cursor++] = m_pairs[p + 1];
+        }
+    }
+    m_stats.index_count = offset;
+
+    upload(m_grid_buffer, m_grid.data(), m_grid.size() * sizeof(u32));
+    upload(m_indices_buffer, m_indices.data(), m_indices.size() * sizeof(u32));
+}
+
+void clustered_lighting::assign_gpu(u32 light_count)
+{
+    const u32 zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_counter_buffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    m_assign->bind();
+    m_assign->set_int("u_light_count"_id, (i32) light_count);
+    m_assign->set_int("u_max_per_cluster"_id, (i32) m_settings.max_lights_per_cluster);
+    m_assign->set_int("u_max_indices"_id, (i32) m_settings.max_indices);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, cluster_lights_binding, m_lights_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, cluster_grid_binding, m_grid_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, cluster_indices_binding, m_indices_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, cluster_bounds_binding, m_bounds_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, cluster_counter_binding, m_counter_buffer);
+
+    glDispatchCompute(cluster_count(), 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void clustered_lighting::bind(const shader& program) const
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, cluster_lights_binding, m_lights_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, cluster_grid_binding, m_grid_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, cluster_indices_binding, m_indices_buffer);
+
+    program.bind();
+    program.set_int("u_cluster_tiles_x"_id, (i32) m_settings.tiles_x);
+    program.set_int("u_cluster_tiles_y"_id, (i32) m_settings.tiles_y);
+    program.set_int("u_cluster_slices"_id, (i32) m_settings.slices);
+    program.set_float("u_cluster_z_scale"_id, m_z_scale);
+    program.set_float("u_cluster_z_bias"_id, m_z_bias);
+    program.set_float("u_cluster_tile_width"_id, (f32) m_screen_width / (f32) m_settings.tiles_x);
+    program.set_float("u_cluster_tile_height"_id, (f32) m_screen_height / (f32) m_settings.tiles_y);
+}
+
+} // namespace blaze::gfx
@@ -0,0 +1,177 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#include "Graphics/DeletionQueue.h"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <GL/glew.h>
+
+#include "Core/Logger.h"
+
+namespace blaze::gfx::deletion
+{
+
+namespace
+{
+struct entry
+{
+    gl_object type;
+    u32       id;
+    u64       bytes;
+};
+
+struct batch
+{
+    GLsync             fence{};
+    std::vector<entry> entries{};
+};
+
+bool              active = false;
+batch             open_batch{};
+std::deque<batch> in_flight{};
+std::vector<u32>  ids{}; // scratch for the glDelete* calls
+stats             current{};
+
+void delete_objects(gl_object type, GLsizei count, const u32* objects)
+{
+    switch (type)
+    {
+    case gl_object::buffer: glDeleteBuffers(count, objects); break;
+    case gl_object::texture: glDeleteTextures(count, objects); break;
+    case gl_object::renderbuffer: glDeleteRenderbuffers(count, objects); break;
+    case gl_object::framebuffer: glDeleteFramebuffers(count, objects); break;
+    case gl_object::vertex_array: glDeleteVertexArrays(count, objects); break;
+    case gl_object::query: glDeleteQueries(count, objects); break;
+    case gl_object::program:
+        for (GLsizei i = 0; i < count; ++i)
+        {
+            glDeleteProgram(objects[i]);
+        }
+        break;
+    case gl_object::count: break;
+    }
+}
+
+// One glDelete* call per object type
+void release(batch& b)
+{
+    std::sort(b.entries.begin(), b.entries.end(), [](const entry& a, const entry& c) { return a.type < c.type; });
+    for (size_t first = 0; first < b.entries.size();)
+    {
+        const gl_object type = b.entries[first].type;
+        ids.clear();
+        size_t last = first;
+        for (; last < b.entries.size() && b.entries[last].type == type; ++last)
+        {
+            ids.emplace_back(b.entries[last].id);
+            current.pending_bytes -= b.entries[last].bytes;
+        }
+        delete_objects(type, (GLsizei) ids.size(), ids.data());
+
+        current.counts[(u32) type] -= (u32) ids.size();
+        current.pending_objects -= (u32) ids.size();
+        current.released_objects += ids.size();
+        first = last;
+    }
+
+    if (b.fence)
+    {
+        glDeleteSync(b.fence);
+    }
+    b = {};
+}
+} // anonymous namespace
+
+void retire(gl_object type, u32 id, u64 bytes)
+{
+    if (id == 0 || id == u32_invalid_id)
+    {
+        return;
+    }
+    if (!active)
+    {
+        delete_objects(type, 1, &id);
+        return;
+    }
+
+    open_batch.entries.push_back({ type, id, bytes });
+    ++current.counts[(u32) type];
+    ++current.pending_objects;
+    current.pending_bytes += bytes;
+}
+
+const stats& pending()
+{
+    current.pending_batches = (u32) in_flight.size() + (open_batch.entries.empty() ? 0 : 1);
+    return current;
+}
+
+namespace detail
+{
+void init()
+{
+    active  = true;
+    current = {};
+}
+
+void end_frame()
+{
+    if (!open_batch.entries.empty())
+    {
+        open_batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        in_flight.emplace_back(std::move(open_batch));
+        open_batch = {};
+    }
+
+    // Batches retire in submission order, stop at the first one the GPU hasn't reached
+    while (!in_flight.empty())
+    {
+        const GLenum result = glClientWaitSync(in_flight.front().fence, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        release(in_flight.front());
+        in_flight.pop_front();
+    }
+}
+
+void flush()
+{
+    if (!active)
+    {
+        return;
+    }
+
+    glFinish();
+    for (auto& b : in_flight)
+    {
+        release(b);
+    }
+    in_flight.clear();
+    release(open_batch);
+
+    LOG_INFO("Deletion queue flushed, {} objects released", current.released_objects);
+    active = false;
+}
+} // namespace detail
+
+} // namespace blaze::gfx::deletion
@@ -0,0 +1,192 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+#include "Graphics/EglContext.h"
+
+#include "Core/Logger.h"
+
+#ifdef BLAZE_HAS_EGL
+    #include <cstring>
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
+
+namespace blaze::gfx::egl
+{
+
+#ifdef BLAZE_HAS_EGL
+
+namespace
+{
+EGLDisplay display = EGL_NO_DISPLAY;
+EGLContext context = EGL_NO_CONTEXT;
+
+bool has_extension(const char* extensions, const char* name)
+{
+    return extensions && std::strstr(extensions, name);
+}
+
+EGLDisplay open_display()
+{
+    // Prefer Mesa's surfaceless platform, it doesn't need a GPU device node or a display server
+    const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto        get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display && has_extension(client_extensions, "EGL_MESA_platform_surfaceless"))
+    {
+        EGLDisplay surfaceless = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (surfaceless != EGL_NO_DISPLAY)
+        {
+            return surfaceless;
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+} // anonymous namespace
+
+bool available()
+{
+    return true;
+}
+
+bool create_context()
+{
+    if (context != EGL_NO_CONTEXT)
+    {
+        return false;
+    }
+
+    display = open_display();
+    EGLint major;
+    EGLint minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        LOG_ERROR("Failed to initialize EGL display: 0x{:x}", eglGetError());
+        return false;
+    }
+
+    if (!has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        LOG_ERROR("EGL {}.{} does not support surfaceless contexts", major, minor);
+        destroy_context();
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        LOG_ERROR("EGL cannot create desktop OpenGL contexts");
+        destroy_context();
+        return false;
+    }
+
+    const EGLint config_attributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig    config;
+    EGLint       config_count;
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &config_count) || config_count == 0)
+    {
+        LOG_ERROR("No EGL config supports desktop OpenGL");
+        destroy_context();
+        return false;
+    }
+
+    // Same version the windowed backend asks for, with 4.3 as the floor compute shaders need
+    constexpr EGLint versions[][2] = { { 4, 5 }, { 4, 3 } };
+    for (const auto& version : versions)
+    {
+        const EGLint context_attributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION,
+            version[0],
+            EGL_CONTEXT_MINOR_VERSION,
+            version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK,
+            EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#ifdef _DEBUG
+            EGL_CONTEXT_OPENGL_DEBUG,
+            EGL_TRUE,
+#endif
+            EGL_NONE,
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+        if (context != EGL_NO_CONTEXT)
+        {
+            break;
+        }
+    }
+
+    if (context == EGL_NO_CONTEXT)
+    {
+        LOG_ERROR("Failed to create EGL context: 0x{:x}", eglGetError());
+        destroy_context();
+        return false;
+    }
+
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        LOG_ERROR("Failed to make EGL context current: 0x{:x}", eglGetError());
+        destroy_context();
+        return false;
+    }
+
+    return true;
+}
+
+void destroy_context()
+{
+    if (display == EGL_NO_DISPLAY)
+    {
+        return;
+    }
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+}
+
+void* get_proc_address(const char* name)
+{
+    return (void*) eglGetProcAddress(name);
+}
+
+#else
+
+bool available()
+{
+    return false;
+}
+
+bool create_context()
+{
+    LOG_ERROR("Headless rendering needs EGL, which this build was configured without");
+    return false;
+}
+
+void destroy_context() {}
+
+void* get_proc_address(const char*)
+{
+    return nullptr;
+}
+
+#endif
+
+} // namespace blaze::gfx::egl
@@ -0,0 +1,368 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+#include "Graphics/FrameCapture.h"
+
+#include <cstring>
+#include <GL/glew.h>
+
+#include "Graphics/DeletionQueue.h"
+#include "Core/Logger.h"
+
+namespace blaze::gfx
+{
+
+namespace
+{
+constexpr u32 convert_group_size = 8; // local_size of capture_nv12.cs, each invocation covers 4x2 pixels
+constexpr u64 flush_wait_ns      = 1'000'000;
+} // anonymous namespace
+
+frame_capture::~frame_capture()
+{
+    destroy();
+}
+
+bool frame_capture::create(i32 width, i32 height, capture_format format, u32 ring_size)
+{
+    destroy();
+    if (width <= 0 || height <= 0 || ring_size < 2)
+    {
+        LOG_ERROR("Invalid capture setup {}x{} with {} buffers", width, height, ring_size);
+        return false;
+    }
+
+    if (format == capture_format::nv12)
+    {
+        if (width % 4 != 0 || height % 2 != 0)
+        {
+            LOG_ERROR("NV12 capture needs a width divisible by 4 and an even height, got {}x{}", width, height);
+            return false;
+        }
+
+        m_convert = make_uptr<shader>("capture_nv12");
+        if (!m_convert->load_compute())
+        {
+            m_convert.reset();
+            return false;
+        }
+
+        glGenTextures(1, &m_staging);
+        glBindTexture(GL_TEXTURE_2D, m_staging);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &m_staging_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_staging_fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_staging, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        m_frame_size = (u64) width * height * 3 / 2;
+    } else
+    {
+        m_frame_size = (u64) width * height * 4;
+    }
+
+    m_width  = width;
+    m_height = height;
+    m_format = format;
+    m_ring.resize(ring_size);
+    for (auto& s : m_ring)
+    {
+        glGenBuffers(1, &s.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr) m_frame_size, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void frame_capture::destroy()
+{
+    stop_worker();
+    for (auto& s : m_ring)
+    {
+        if (s.fence)
+        {
+            glDeleteSync((GLsync) s.fence);
+        }
+        deletion::retire(gl_object::buffer, s.buffer, m_frame_size);
+    }
+    m_ring.clear();
+    m_head    = 0;
+    m_pending = 0;
+
+    if (m_staging_fbo)
+    {
+        deletion::retire(gl_object::framebuffer, m_staging_fbo);
+        deletion::retire(gl_object::texture, m_staging, (u64) m_width * m_height * 4);
+        m_staging_fbo = 0;
+        m_staging     = 0;
+    }
+    m_convert.reset();
+}
+
+void frame_capture::set_callback(callback cb)
+{
+    m_callback = std::move(cb);
+}
+
+void frame_capture::use_worker_thread(bool enable)
+{
+    if (!enable)
+    {
+        stop_worker();
+        return;
+    }
+    if (m_worker.joinable())
+    {
+        return;
+    }
+
+    // One spare buffer per ring slot, more than that means the worker can't keep up and frames get dropped
+    m_free_buffers.resize(m_ring.size());
+    for (auto& buffer : m_free_buffers)
+    {
+        buffer.resize(m_frame_size);
+    }
+    m_stop   = false;
+    m_worker = std::thread(&frame_capture::worker_main, this);
+}
+
+frame_capture::slot* frame_capture::acquire()
+{
+    if (m_ring.empty())
+    {
+        return nullptr;
+    }
+
+    // Try to make room before giving up on this frame, but never wait for it
+    if (m_pending == m_ring.size() && !retire(false))
+    {
+        ++m_dropped;
+        return nullptr;
+    }
+    return &m_ring[m_head];
+}
+
+void frame_capture::submit(slot& s)
+{
+    s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s.index = m_next_index++;
+    m_head  = (m_head + 1) % (u32) m_ring.size();
+    ++m_pending;
+}
+
+bool frame_capture::capture_framebuffer(u32 framebuffer)
+{
+    slot* s = acquire();
+    if (!s)
+    {
+        return false;
+    }
+
+    // The read buffer is state of the framebuffer being read, put it back before unbinding
+    GLint previous_read;
+    GLint previous_read_buffer;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_read);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glGetIntegerv(GL_READ_BUFFER, &previous_read_buffer);
+    glReadBuffer(framebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+
+    if (m_format == capture_format::nv12)
+    {
+        GLint previous_draw;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_draw);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_staging_fbo);
+        glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glReadBuffer((GLenum) previous_read_buffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint) previous_read);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint) previous_draw);
+        convert(*s, m_staging);
+        return true;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s->buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glReadBuffer((GLenum) previous_read_buffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint) previous_read);
+
+    submit(*s);
+    return true;
+}
+
+bool frame_capture::capture_texture(u32 texture)
+{
+    if (m_format != capture_format::nv12)
+    {
+        LOG_ERROR("Texture capture is only supported for nv12");
+        return false;
+    }
+
+    slot* s = acquire();
+    if (!s)
+    {
+        return false;
+    }
+    convert(*s, texture);
+    return true;
+}
+
+void frame_capture::convert(slot& s, u32 texture)
+{
+    m_convert->bind();
+    m_convert->set_int("u_width"_id, m_width);
+    m_convert->set_int("u_height"_id, m_height);
+    m_convert->set_bool("u_flip"_id, true);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, s.buffer);
+
+    const u32 blocks_x = (u32) m_width / 4;
+    const u32 blocks_y = (u32) m_height / 2;
+    glDispatchCompute((blocks_x + convert_group_size - 1) / convert_group_size,
+                      (blocks_y + convert_group_size - 1) / convert_group_size, 1);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+
+    submit(s);
+}
+
+void frame_capture::poll()
+{
+    while (retire(false)) {}
+}
+
+void frame_capture::flush()
+{
+    while (retire(true)) {}
+}
+
+bool frame_capture::retire(bool wait)
+{
+    if (m_pending == 0)
+    {
+        return false;
+    }
+
+    const u32 ring_size = (u32) m_ring.size();
+    slot&     oldest    = m_ring[(m_head + ring_size - m_pending) % ring_size];
+    // The flush bit makes sure the fence is actually submitted, headless contexts never swap
+    GLenum result = glClientWaitSync((GLsync) oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (wait && result == GL_TIMEOUT_EXPIRED)
+    {
+        result = glClientWaitSync((GLsync) oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, flush_wait_ns);
+    }
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+    {
+        return false;
+    }
+
+    glDeleteSync((GLsync) oldest.fence);
+    oldest.fence = nullptr;
+    --m_pending;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, oldest.buffer);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr) m_frame_size, GL_MAP_READ_BIT);
+    if (data)
+    {
+        deliver(oldest, (const u8*) data);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else
+    {
+        LOG_ERROR("Failed to map capture buffer {}", oldest.index);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void frame_capture::deliver(const slot& s, const u8* data)
+{
+    if (!m_worker.joinable())
+    {
+        if (m_callback)
+        {
+            m_callback({ data, m_frame_size, m_width, m_height, m_format, s.index });
+        }
+        return;
+    }
+
+    std::vector<u8> buffer;
+    {
+        std::lock_guard lock{ m_mutex };
+        if (m_free_buffers.empty())
+        {
+            ++m_dropped;
+            return;
+        }
+        buffer = std::move(m_free_buffers.back());
+        m_free_buffers.pop_back();
+    }
+
+    std::memcpy(buffer.data(), data, m_frame_size);
+    {
+        std::lock_guard lock{ m_mutex };
+        m_jobs.push_back({ std::move(buffer), s.index });
+    }
+    m_wake.notify_one();
+}
+
+void frame_capture::stop_worker()
+{
+    if (!m_worker.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard lock{ m_mutex };
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+    m_jobs.clear();
+    m_free_buffers.clear();
+}
+
+void frame_capture::worker_main()
+{
+    std::unique_lock lock{ m_mutex };
+    while (true)
+    {
+        m_wake.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+        if (m_jobs.empty())
+        {
+            return;
+        }
+
+        job next = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        lock.unlock();
+
+        if (m_callback)
+        {
+            m_callback({ next.data.data(), m_frame_size, m_width, m_height, m_format, next.index });
+        }
+
+        lock.lock();
+        m_free_buffers.push_back(std::move(next.data));
+    }
+}
+
+} // namespace blaze::gfx
@@ -0,0 +1,581 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+#include "Graphics/FrameGraph.h"
+
+#include <algorithm>
+#include <format>
+#include <GL/glew.h>
+
+#include "Core/Memory.h"
+#include "Graphics/DeletionQueue.h"
+#include "Core/Logger.h"
+
+namespace blaze::gfx
+{
+
+namespace
+{
+constexpr u32 max_color_attachments = 8;
+
+bool is_depth(texture_format format)
+{
+    return format == texture_format::depth24_stencil8 || format == texture_format::depth32f;
+}
+
+GLenum internal_format(texture_format format)
+{
+    switch (format)
+    {
+    case texture_format::rgba8: return GL_RGBA8;
+    case texture_format::rgba16f: return GL_RGBA16F;
+    case texture_format::r32f: return GL_R32F;
+    case texture_format::depth24_stencil8: return GL_DEPTH24_STENCIL8;
+    case texture_format::depth32f: return GL_DEPTH_COMPONENT32F;
+    }
+    return GL_RGBA8;
+}
+
+const char* format_name(texture_format format)
+{
+    switch (format)
+    {
+    case texture_format::rgba8: return "rgba8";
+    case texture_format::rgba16f: return "rgba16f";
+    case texture_format::r32f: return "r32f";
+    case texture_format::depth24_stencil8: return "d24s8";
+    case texture_format::depth32f: return "d32f";
+    }
+    return "unknown";
+}
+
+u32 create_texture(const texture_desc& desc)
+{
+    const GLint filter = is_depth(desc.format) ? GL_NEAREST : GL_LINEAR;
+    u32         texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, internal_format(desc.format), desc.width, desc.height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+void add_unique(std::vector<u32>& list, u32 value)
+{
+    if (std::find(list.begin(), list.end(), value) == list.end())
+    {
+        list.push_back(value);
+    }
+}
+} // anonymous namespace
+
+u64 texture_bytes(const texture_desc& desc)
+{
+    const u64 pixels = (u64) desc.width * (u64) desc.height;
+    return desc.format == texture_format::rgba16f ? pixels * 8 : pixels * 4;
+}
+
+// ---- pass_builder ----
+
+frame_resource pass_builder::create(const std::string& name, const texture_desc& desc)
+{
+    m_graph.m_resources.push_back({ .name = name, .desc = desc });
+    return { (u32) m_graph.m_resources.size() - 1 };
+}
+
+frame_resource pass_builder::read(frame_resource resource)
+{
+    if (resource.index < m_graph.m_resources.size())
+    {
+        add_unique(m_graph.m_passes[m_pass].reads, resource.index);
+    }
+    return resource;
+}
+
+frame_resource pass_builder::write(frame_resource resource)
+{
+    if (resource.index < m_graph.m_resources.size())
+    {
+        add_unique(m_graph.m_passes[m_pass].writes, resource.index);
+    }
+    return resource;
+}
+
+void pass_builder::side_effect()
+{
+    m_graph.m_passes[m_pass].side_effect = true;
+}
+
+// ---- pass_resources ----
+
+u32 pass_resources::texture(frame_resource resource) const
+{
+    return m_graph.m_resources[resource.index].texture;
+}
+
+const texture_desc& pass_resources::desc(frame_resource resource) const
+{
+    return m_graph.m_resources[resource.index].desc;
+}
+
+// ---- frame_graph ----
+
+frame_graph::~frame_graph()
+{
+    release();
+}
+
+frame_resource frame_graph::import_texture(const std::string& name, const texture_desc& desc, u32 texture)
+{
+    m_resources.push_back({ .name = name, .desc = desc, .imported = true, .texture = texture });
+    return { (u32) m_resources.size() - 1 };
+}
+
+frame_resource frame_graph::import_framebuffer(const std::string& name, i32 width, i32 height, u32 framebuffer)
+{
+    m_resources.push_back({ .name           = name,
+                            .desc           = { width, height, texture_format::rgba8 },
+                            .imported       = true,
+                            .framebuffer    = framebuffer,
+                            .is_framebuffer = true });
+    return { (u32) m_resources.size() - 1 };
+}
+
+void frame_graph::add_pass(const std::string& name, const setup_function& setup, const execute_function& execute)
+{
+    m_passes.push_back({ .name = name, .execute = execute });
+    m_compiled = false;
+    pass_builder builder{ *this, (u32) m_passes.size() - 1 };
+    setup(builder);
+}
+
+bool frame_graph::compile()
+{
+    m_stats = {};
+    cull();
+    sort();
+    if (m_order.size() != m_stats.passes)
+    {
+        LOG_ERROR("Frame graph has a dependency cycle, {} of {} passes could be ordered", m_order.size(), m_stats.passes);
+        return false;
+    }
+    assign_physical();
+    m_compiled = true;
+    return true;
+}
+
+void frame_graph::cull()
+{
+    // Walk backwards from the imported resources, a pass survives if something downstream needs what it writes
+    memory::frame_vector<bool> needed(m_resources.size(), false);
+    for (u32 i = 0; i < m_resources.size(); ++i)
+    {
+        needed[i] = m_resources[i].imported;
+    }
+
+    for (u32 i = (u32) m_passes.size(); i-- > 0;)
+    {
+        pass& p    = m_passes[i];
+        bool  keep = p.side_effect;
+        for (u32 w : p.writes)
+        {
+            keep = keep || needed[w];
+        }
+
+        p.culled = !keep;
+        if (keep)
+        {
+            for (u32 r : p.reads)
+            {
+                needed[r] = true;
+            }
+            ++m_stats.passes;
+        } else
+        {
+            ++m_stats.culled_passes;
+        }
+    }
+}
+
+void frame_graph::sort()
+{
+    // The graph is rebuilt every frame, so all the scratch comes from the frame arena
+    const u32                                       pass_count = (u32) m_passes.size();
+    memory::frame_vector<memory::frame_vector<u32>> edges(pass_count);
+    memory::frame_vector<u32>                       incoming(pass_count, 0);
+    memory::frame_vector<u32>                       last_writer(m_resources.size(), u32_invalid_id);
+    memory::frame_vector<memory::frame_vector<u32>> readers(m_resources.size());
+
+    auto add_edge = [&](u32 from, u32 to) {
+        if (from != u32_invalid_id && from != to)
+        {
+            edges[from].push_back(to);
+            ++incoming[to];
+        }
+    };
+
+    // Declaration order defines the dependencies: read after write, write after write and write after read
+    for (u32 i = 0; i < pass_count; ++i)
+    {
+        const pass& p = m_passes[i];
+        if (p.culled)
+        {
+            continue;
+        }
+        for (u32 r : p.reads)
+        {
+            add_edge(last_writer[r], i);
+            readers[r].push_back(i);
+        }
+        for (u32 w : p.writes)
+        {
+            add_edge(last_writer[w], i);
+            for (u32 reader : readers[w])
+            {
+                add_edge(reader, i);
+            }
+            readers[w].clear();
+            last_writer[w] = i;
+        }
+    }
+
+    // Kahn's algorithm. Among the ready passes prefer one with the same targets as the last, it reuses the bound
+    // framebuffer, otherwise fall back to declaration order
+    memory::frame_vector<u32> ready{};
+    for (u32 i = 0; i < pass_count; ++i)
+    {
+        if (!m_passes[i].culled && incoming[i] == 0)
+        {
+            ready.push_back(i);
+        }
+    }
+
+    m_order.clear();
+    const std::vector<u32>* previous_targets = nullptr;
+    while (!ready.empty())
+    {
+        auto pick = std::min_element(ready.begin(), ready.end());
+        if (previous_targets)
+        {
+            for (auto it = ready.begin(); it != ready.end(); ++it)
+            {
+                if (m_passes[*it].writes == *previous_targets && (*pick > *it || m_passes[*pick].writes != *previous_targets))
+                {
+                    pick = it;
+                }
+            }
+        }
+
+        const u32 next = *pick;
+        ready.erase(pick);
+        m_order.push_back(next);
+        previous_targets = &m_passes[next].writes;
+
+        for (u32 to : edges[next])
+        {
+            if (--incoming[to] == 0)
+            {
+                ready.push_back(to);
+            }
+        }
+    }
+}
+
+void frame_graph::assign_physical()
+{
+    for (auto& r : m_resources)
+    {
+        r.first_use = u32_invalid_id;
+        r.last_use  = 0;
+    }
+    for (u32 k = 0; k < m_order.size(); ++k)
+    {
+        const pass& p = m_passes[m_order[k]];
+        for (const auto* list : { &p.reads, &p.writes })
+        {
+            for (u32 index : *list)
+            {
+                resource& r = m_resources[index];
+                r.first_use = std::min(r.first_use, k);
+                r.last_use  = std::max(r.last_use, k);
+            }
+        }
+    }
+
+    memory::frame_vector<u32> transients{};
+    for (u32 i = 0; i < m_resources.size(); ++i)
+    {
+        if (!m_resources[i].imported && m_resources[i].first_use != u32_invalid_id)
+        {
+            transients.push_back(i);
+        }
+    }
+    std::sort(transients.begin(), transients.end(),
+              [this](u32 a, u32 b) { return m_resources[a].first_use < m_resources[b].first_use; });
+
+    for (auto& physical : m_physical)
+    {
+        physical.in_use    = false;
+        physical.last_user = u32_invalid_id;
+    }
+
+    // Greedy interval assignment by first use. Each transient takes the first texture with an identical desc that's free
+    // by then. This is pooling, not memory aliasing: differently shaped transients never share storage
+    for (u32 index : transients)
+    {
+        resource& r = m_resources[index];
+        m_stats.unpooled_bytes += texture_bytes(r.desc);
+
+        u32 chosen = u32_invalid_id;
+        for (u32 i = 0; i < m_physical.size(); ++i)
+        {
+            const physical_texture& physical = m_physical[i];
+            if (physical.desc == r.desc && (!physical.in_use || physical.last_user < r.first_use))
+            {
+                chosen = i;
+                break;
+            }
+        }
+        if (chosen == u32_invalid_id)
+        {
+            m_physical.push_back({ .desc = r.desc, .texture = create_texture(r.desc) });
+            chosen = (u32) m_physical.size() - 1;
+        }
+
+        physical_texture& physical = m_physical[chosen];
+        physical.in_use            = true;
+        physical.last_user         = r.last_use;
+        r.physical                 = chosen;
+        r.texture                  = physical.texture;
+    }
+
+    // Textures nobody wanted this frame (resize, feature toggled off) are freed along with the cached framebuffers
+    // attaching them. partition rather than remove_if, the tail has to hold the unused entries themselves to retire them
+    const auto unused = std::partition(m_physical.begin(), m_physical.end(), [](const physical_texture& p) { return p.in_use; });
+    if (unused != m_physical.end())
+    {
+        for (auto it = unused; it != m_physical.end(); ++it)
+        {
+            const u32 texture = it->texture;
+            std::erase_if(m_framebuffers, [texture](const auto& entry) {
+                const std::vector<u32>& attached = entry.second.textures;
+                if (std::find(attached.begin(), attached.end(), texture) == attached.end())
+                {
+                    return false;
+                }
+                deletion::retire(gl_object::framebuffer, entry.second.framebuffer);
+                return true;
+            });
+            deletion::retire(gl_object::texture, texture, texture_bytes(it->desc));
+        }
+        m_physical.erase(unused, m_physical.end());
+
+        // Removing entries shifted the indices
+        for (u32 index : transients)
+        {
+            for (u32 i = 0; i < m_physical.size(); ++i)
+            {
+                if (m_physical[i].texture == m_resources[index].texture)
+                {
+                    m_resources[index].physical = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (const auto& physical : m_physical)
+    {
+        m_stats.transient_bytes += texture_bytes(physical.desc);
+    }
+}
+
+u32 frame_graph::framebuffer_for(const pass& p)
+{
+    u64 key = 14695981039346656037ull;
+    for (u32 w : p.writes)
+    {
+        const resource& r = m_resources[w];
+        if (r.is_framebuffer)
+        {
+            return r.framebuffer;
+        }
+        key = (key ^ r.texture) * 1099511628211ull;
+    }
+
+    auto it = m_framebuffers.find(key);
+    if (it != m_framebuffers.end())
+    {
+        return it->second.framebuffer;
+    }
+
+    u32 framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    GLenum             draw_buffers[max_color_attachments];
+    u32                color_count = 0;
+    cached_framebuffer cached{ .framebuffer = framebuffer };
+    for (u32 w : p.writes)
+    {
+        const resource& r = m_resources[w];
+        cached.textures.push_back(r.texture);
+        if (r.desc.format == texture_format::depth24_stencil8)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, r.texture, 0);
+        } else if (r.desc.format == texture_format::depth32f)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, r.texture, 0);
+        } else if (color_count < max_color_attachments)
+        {
+            draw_buffers[color_count] = GL_COLOR_ATTACHMENT0 + color_count;
+            glFramebufferTexture2D(GL_FRAMEBUFFER, draw_buffers[color_count], GL_TEXTURE_2D, r.texture, 0);
+            ++color_count;
+        }
+    }
+    if (color_count)
+    {
+        glDrawBuffers((GLsizei) color_count, draw_buffers);
+    } else
+    {
+        glDrawBuffer(GL_NONE);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_ERROR("Framebuffer for pass [{}] is incomplete", p.name);
+    }
+
+    m_framebuffers.emplace(key, std::move(cached));
+    return framebuffer;
+}
+
+void frame_graph::execute()
+{
+    if (!m_compiled && !compile())
+    {
+        return;
+    }
+
+    const pass_resources resources{ *this };
+    u32                  bound = u32_invalid_id;
+    for (u32 index : m_order)
+    {
+        pass& p = m_passes[index];
+        if (!p.writes.empty())
+        {
+            const u32 framebuffer = framebuffer_for(p);
+            if (framebuffer != bound)
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+                bound = framebuffer;
+                ++m_stats.framebuffer_binds;
+            }
+            const texture_desc& target = m_resources[p.writes.front()].desc;
+            glViewport(0, 0, target.width, target.height);
+        }
+
+        if (p.execute)
+        {
+            p.execute(resources);
+        }
+    }
+}
+
+void frame_graph::reset()
+{
+    m_resources.clear();
+    m_passes.clear();
+    m_order.clear();
+    m_compiled = false;
+}
+
+void frame_graph::release()
+{
+    reset();
+    for (auto& [key, cached] : m_framebuffers)
+    {
+        deletion::retire(gl_object::framebuffer, cached.framebuffer);
+    }
+    m_framebuffers.clear();
+    for (auto& physical : m_physical)
+    {
+        deletion::retire(gl_object::texture, physical.texture, texture_bytes(physical.desc));
+    }
+    m_physical.clear();
+}
+
+std::string frame_graph::dump() const
+{
+    std::string out = std::format("frame graph: {} passes, {} culled, transient memory {:.2f}MB pooled / {:.2f}MB unpooled\n",
+                                  m_stats.passes, m_stats.culled_passes, (f64) m_stats.transient_bytes / (1024.0 * 1024.0),
+                                  (f64) m_stats.unpooled_bytes / (1024.0 * 1024.0));
+
+    out += "resources:\n";
+    for (const auto& r : m_resources)
+    {
+        if (r.first_use == u32_invalid_id)
+        {
+            out += std::format("  {:<24} unused\n", r.name);
+            continue;
+        }
+        out += std::format("  {:<24} {}x{} {:<7} {:<9} passes [{}, {}]", r.name, r.desc.width, r.desc.height,
+                           format_name(r.desc.format), r.imported ? "imported" : "transient", r.first_use, r.last_use);
+        if (!r.imported)
+        {
+            out += std::format(" -> physical #{} ({:.2f}MB)", r.physical, (f64) texture_bytes(r.desc) / (1024.0 * 1024.0));
+        }
+        out += "\n";
+    }
+
+    auto names = [this](const std::vector<u32>& list) {
+        std::string joined;
+        for (u32 index : list)
+        {
+            joined += joined.empty() ? m_resources[index].name : ", " + m_resources[index].name;
+        }
+        return joined;
+    };
+
+    out += "passes (execution order):\n";
+    for (u32 k = 0; k < m_order.size(); ++k)
+    {
+        const pass& p      = m_passes[m_order[k]];
+        u64         memory = 0;
+        for (u32 w : p.writes)
+        {
+            memory += m_resources[w].is_framebuffer ? 0 : texture_bytes(m_resources[w].desc);
+        }
+        out += std::format("  {:>2}: {:<24} reads [{}] writes [{}] targets {:.2f}MB\n", k, p.name, names(p.reads),
+                           names(p.writes), (f64) memory / (1024.0 * 1024.0));
+    }
+    for (const auto& p : m_passes)
+    {
+        if (p.culled)
+        {
+            out += std::format("  culled: {}\n", p.name);
+        }
+    }
+    return out;
+}
+
+} // namespace blaze::gfx
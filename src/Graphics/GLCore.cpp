@@ -18,6 +18,10 @@
 //  ------------------------------------------------------------------------------
 #include "Graphics/GLCore.h"
 #include "Graphics/Shader.h"
+#include "Graphics/ShaderLibrary.h"
+#include "Graphics/DeletionQueue.h"
+#include "Graphics/UniformBlocks.h"
+#include "Core/Logger.h"
 
 #include <gl/glew.h>
 #include <iostream>
@@ -40,8 +44,12 @@ namespace blaze::gfx
 namespace
 {
 bool is_init = false;
-shader test{"test"};
-u32 vao;
+renderer_info info{};
+// Created in init() and released in shutdown(), a static shader would be destroyed after the context
+uptr<shader> test{};
+u32 vao{};
+u32 vbo{};
+u32 empty_vao{};
 
 const char* get_error_string(GLenum error)
 {
@@ -70,9 +78,61 @@ void GLAPIENTRY error_callback(GLenum source, GLenum type, GLuint id, GLenum sev
     std::cerr << "---------------------opengl-error-callback-end--------------" << std::endl;
 }
 
+// Every entry point the engine calls past GL 1.1, those are exported by libGL itself rather than loaded. New calls
+// have to be added here or they may be null under EGL
+#define BLAZE_GL_ENTRY_POINTS(X)                                                                                        \
+    X(glActiveTexture) X(glAttachShader) X(glBeginQuery) X(glBindBuffer) X(glBindBufferBase) X(glBindBufferRange)      \
+    X(glBindFramebuffer) X(glBindRenderbuffer) X(glBindVertexArray) X(glBlitFramebuffer) X(glBufferData)              \
+    X(glBufferStorage) X(glBufferSubData) X(glCheckFramebufferStatus) X(glClearBufferData) X(glClearTexImage)         \
+    X(glClientWaitSync) X(glCompileShader) X(glCopyBufferSubData) X(glCreateProgram) X(glCreateShader)                \
+    X(glDebugMessageCallback) X(glDeleteBuffers) X(glDeleteFramebuffers) X(glDeleteProgram) X(glDeleteQueries)        \
+    X(glDeleteRenderbuffers) X(glDeleteShader) X(glDeleteSync) X(glDeleteVertexArrays) X(glDispatchCompute)           \
+    X(glDispatchComputeIndirect) X(glDrawArraysIndirect) X(glDrawArraysInstancedBaseInstance) X(glDrawBuffers)        \
+    X(glEnableVertexAttribArray) X(glEndQuery) X(glFenceSync) X(glFramebufferRenderbuffer)                            \
+    X(glFramebufferTexture2D) X(glGenBuffers) X(glGenFramebuffers) X(glGenQueries) X(glGenRenderbuffers)              \
+    X(glGenVertexArrays) X(glGetBufferSubData) X(glGetProgramInfoLog) X(glGetProgramInterfaceiv)                      \
+    X(glGetProgramResourceIndex) X(glGetProgramResourceName) X(glGetProgramResourceiv) X(glGetProgramiv)              \
+    X(glGetQueryObjectui64v) X(glGetShaderInfoLog) X(glGetShaderiv) X(glInvalidateBufferData)                         \
+    X(glLinkProgram) X(glMapBufferRange) X(glMemoryBarrier) X(glRenderbufferStorage) X(glShaderSource)                \
+    X(glTexStorage2D) X(glUniform1f) X(glUniform1i) X(glUniform3fv) X(glUniform4fv) X(glUniformBlockBinding)          \
+    X(glUniformMatrix4fv) X(glUnmapBuffer) X(glUseProgram) X(glVertexAttribDivisor) X(glVertexAttribPointer)
+
+// A GLX build of GLEW resolves everything through glXGetProcAddress, which only works for an EGL context (Wayland,
+// the headless backend) when glvnd dispatches it. Elsewhere those pointers come back null, so they're loaded again
+// through the context's own loader
+bool load_entry_points(proc_loader get_proc_address)
+{
+    bool loaded = true;
+#define BLAZE_LOAD_ENTRY_POINT(name)                                                                                   \
+    if (!name)                                                                                                         \
+    {                                                                                                                  \
+        name = (decltype(name)) get_proc_address(#name);                                                               \
+    }                                                                                                                  \
+    if (!name)                                                                                                         \
+    {                                                                                                                  \
+        std::cerr << "Missing GL entry point " << #name << std::endl;                                                   \
+        loaded = false;                                                                                                \
+    }
+    BLAZE_GL_ENTRY_POINTS(BLAZE_LOAD_ENTRY_POINT)
+#undef BLAZE_LOAD_ENTRY_POINT
+
+    // Optional, only called when the extension is there
+    if (!glMaxShaderCompilerThreadsKHR)
+    {
+        glMaxShaderCompilerThreadsKHR =
+            (decltype(glMaxShaderCompilerThreadsKHR)) get_proc_address("glMaxShaderCompilerThreadsKHR");
+    }
+    if (!glMaxShaderCompilerThreadsARB)
+    {
+        glMaxShaderCompilerThreadsARB =
+            (decltype(glMaxShaderCompilerThreadsARB)) get_proc_address("glMaxShaderCompilerThreadsARB");
+    }
+    return loaded;
+}
+
 } // anonymous namespace
 
-bool init()
+bool init(proc_loader get_proc_address)
 {
     if (is_init)
     {
@@ -80,25 +140,48 @@ bool init()
     }
     glewExperimental = true;
     u32 status       = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLX builds of GLEW fail their GLX part when the context came from EGL. The GL part already ran, whatever it
+    // couldn't resolve is checked and loaded below
+    if (status == GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        status = GLEW_OK;
+    }
+#endif
     if (status != GLEW_OK)
     {
         std::cerr << "GLEW failed to initialize: " << glewGetErrorString(status) << std::endl;
         return false;
     }
+    if (!load_entry_points(get_proc_address))
+    {
+        std::cerr << "OpenGL entry points failed to load" << std::endl;
+        return false;
+    }
 
     glGetError(); // Clear any errors that glewInit may have caused
+
+    info.vendor   = (const char*) glGetString(GL_VENDOR);
+    info.renderer = (const char*) glGetString(GL_RENDERER);
+    info.version  = (const char*) glGetString(GL_VERSION);
+    LOG_INFO("OpenGL {} on {} ({})", info.version, info.renderer, info.vendor);
 #ifdef _DEBUG
-    std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
     glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
     glDebugMessageCallback(error_callback, nullptr);
 #endif
 
-    if(!test.load())
+    deletion::detail::init();
+    if (!uniforms::init())
+    {
+        return false;
+    }
+
+    test = make_uptr<shader>("test");
+    if(!test->load())
     {
         return false;
     }
 
-    u32 vbo;
     f32 vertices[] = {
         -0.5f, -0.5f, 0.0f, // left
          0.5f, -0.5f, 0.0f, // right
@@ -118,6 +201,33 @@ bool init()
     return true;
 }
 
+void shutdown()
+{
+    if (!is_init)
+    {
+        return;
+    }
+
+    disable_hot_reload();
+    test.reset();
+    shaders().clear();
+    deletion::retire(gl_object::vertex_array, vao);
+    deletion::retire(gl_object::buffer, vbo, 9 * sizeof(f32));
+    deletion::retire(gl_object::vertex_array, empty_vao);
+    vao       = 0;
+    vbo       = 0;
+    empty_vao = 0;
+    uniforms::shutdown();
+
+    deletion::detail::flush();
+    is_init = false;
+}
+
+const renderer_info& renderer()
+{
+    return info;
+}
+
 void clear_screen(f32 r, f32 g, f32 b)
 {
     glClearColor(r, g, b, 1.0f);
@@ -125,12 +235,26 @@ void clear_screen(f32 r, f32 g, f32 b)
 }
 
 void test_shader() {
-    test.bind();
-    test.set_float("red", 0.5f);
-    test.set_float("green", 0.2f);
-    test.set_float("blue", 0.8f);
+    test->bind();
+    uniforms::push(material_block{ .base_color = { 0.5f, 0.2f, 0.8f, 1.0f } });
     GL_CALL(glBindVertexArray(vao));
     GL_CALL(glDrawArrays(GL_TRIANGLES, 0, 3));
 }
 
+void draw_fullscreen_triangle()
+{
+    // Core profile still wants a VAO bound even when there are no attributes
+    if (!empty_vao)
+    {
+        GL_CALL(glGenVertexArrays(1, &empty_vao));
+    }
+    GL_CALL(glBindVertexArray(empty_vao));
+    GL_CALL(glDrawArrays(GL_TRIANGLES, 0, 3));
+}
+
+void finish()
+{
+    glFinish();
+}
+
 } // namespace blaze::gfx
\ No newline at end of file
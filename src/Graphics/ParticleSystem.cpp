@@ -0,0 +1,302 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+#include "Graphics/ParticleSystem.h"
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include <GL/glew.h>
+
+#include "Graphics/DeletionQueue.h"
+#include "Graphics/ShaderLibrary.h"
+#include "Core/Logger.h"
+
+namespace blaze::gfx
+{
+
+namespace
+{
+constexpr u32 group_size = 64; // local_size of the per particle compute shaders
+
+// SSBO bindings, see the particle_*.cs shaders
+constexpr u32 counters_binding      = 8;
+constexpr u32 particles_binding     = 9;
+constexpr u32 dead_list_binding     = 10;
+constexpr u32 alive_current_binding = 11;
+constexpr u32 alive_next_binding    = 12;
+constexpr u32 indirect_binding      = 13;
+
+// Byte offsets into the indirect buffer
+constexpr GLintptr emit_dispatch_offset     = 0;
+constexpr GLintptr simulate_dispatch_offset = 16; // uvec3 is padded to 16 bytes in std430
+constexpr GLintptr draw_offset              = 32;
+constexpr u32      indirect_size            = 48;
+
+// dead_count, alive_count[2], emit_count, requested
+constexpr u32 counter_count = 5;
+
+constexpr u32 particle_size = 48;
+
+u32 create_storage(u64 size, const void* data)
+{
+    u32 buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr) size, data, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return buffer;
+}
+
+bool load_program(shader*& program, const char* name, bool compute)
+{
+    program = compute ? shaders().get_compute(name) : shaders().get(name);
+    return program != nullptr;
+}
+} // anonymous namespace
+
+particle_system::~particle_system()
+{
+    destroy();
+}
+
+bool particle_system::create(u32 capacity)
+{
+    destroy();
+    if (capacity == 0)
+    {
+        return false;
+    }
+
+    if (!load_program(m_kickoff, "particle_kickoff", true) || !load_program(m_emit, "particle_emit", true) ||
+        !load_program(m_simulate, "particle_simulate", true) || !load_program(m_finalize, "particle_finalize", true) ||
+        !load_program(m_render, "particle_render", false))
+    {
+        destroy();
+        return false;
+    }
+
+    m_capacity = capacity;
+
+    // Every slot starts out dead
+    std::vector<u32> dead(capacity);
+    std::iota(dead.begin(), dead.end(), 0u);
+    const u32 counters[counter_count] = { capacity, 0, 0, 0, 0 };
+
+    m_counters  = create_storage(sizeof(counters), counters);
+    m_particles = create_storage((u64) capacity * particle_size, nullptr);
+    m_dead_list = create_storage((u64) capacity * sizeof(u32), dead.data());
+    m_alive[0]  = create_storage((u64) capacity * sizeof(u32), nullptr);
+    m_alive[1]  = create_storage((u64) capacity * sizeof(u32), nullptr);
+    m_indirect  = create_storage(indirect_size, nullptr);
+    glGenVertexArrays(1, &m_vao); // no attributes, everything comes from the SSBOs
+
+    for (auto& slot : m_stats_ring)
+    {
+        glGenQueries(1, &slot.query);
+        glGenBuffers(1, &slot.counters);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, slot.counters);
+        glBufferData(GL_COPY_WRITE_BUFFER, counter_count * sizeof(u32), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    m_current          = 0;
+    m_frame            = 0;
+    m_emit_accumulator = 0.0f;
+    return true;
+}
+
+void particle_system::destroy()
+{
+    const u64 list_bytes = (u64) m_capacity * sizeof(u32);
+    deletion::retire(gl_object::buffer, m_counters, counter_count * sizeof(u32));
+    deletion::retire(gl_object::buffer, m_particles, (u64) m_capacity * particle_size);
+    deletion::retire(gl_object::buffer, m_dead_list, list_bytes);
+    deletion::retire(gl_object::buffer, m_alive[0], list_bytes);
+    deletion::retire(gl_object::buffer, m_alive[1], list_bytes);
+    deletion::retire(gl_object::buffer, m_indirect, indirect_size);
+    deletion::retire(gl_object::vertex_array, m_vao);
+    m_counters = m_particles = m_dead_list = m_alive[0] = m_alive[1] = m_indirect = m_vao = 0;
+    for (auto& slot : m_stats_ring)
+    {
+        if (slot.fence)
+        {
+            glDeleteSync((GLsync) slot.fence);
+        }
+        deletion::retire(gl_object::query, slot.query);
+        deletion::retire(gl_object::buffer, slot.counters, counter_count * sizeof(u32));
+        slot = {};
+    }
+
+    m_kickoff  = nullptr;
+    m_emit     = nullptr;
+    m_simulate = nullptr;
+    m_finalize = nullptr;
+    m_render   = nullptr;
+    m_capacity = 0;
+}
+
+void particle_system::set_gravity(f32 x, f32 y, f32 z)
+{
+    m_gravity[0] = x;
+    m_gravity[1] = y;
+    m_gravity[2] = z;
+}
+
+void particle_system::bind_buffers() const
+{
+    // alive_current/alive_next swap roles every frame by swapping bindings, the shaders never branch on it
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, counters_binding, m_counters);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, particles_binding, m_particles);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, dead_list_binding, m_dead_list);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, alive_current_binding, m_alive[m_current]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, alive_next_binding, m_alive[1 - m_current]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, indirect_binding, m_indirect);
+}
+
+void particle_system::update(f32 dt)
+{
+    if (!m_capacity)
+    {
+        return;
+    }
+
+    collect_stats();
+    stats_slot& slot    = m_stats_ring[m_frame % stats_latency];
+    const bool  measure = !slot.pending;
+    if (measure)
+    {
+        glBeginQuery(GL_TIME_ELAPSED, slot.query);
+    }
+
+    m_emit_accumulator += m_emitter.rate * dt;
+    const u32 requested = (u32) std::min(m_emit_accumulator, (f32) m_capacity);
+    m_emit_accumulator -= (f32) requested;
+
+    bind_buffers();
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_counters);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 4 * sizeof(u32), sizeof(u32), &requested);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, m_indirect);
+
+    m_kickoff->bind();
+    m_kickoff->set_int("u_current"_id, (i32) m_current);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+    m_emit->bind();
+    m_emit->set_int("u_current"_id, (i32) m_current);
+    m_emit->set_vec3("u_position"_id, m_emitter.position);
+    m_emit->set_vec3("u_velocity"_id, m_emitter.velocity);
+    m_emit->set_vec4("u_color"_id, m_emitter.color);
+    m_emit->set_float("u_spread"_id, m_emitter.spread);
+    m_emit->set_float("u_lifetime"_id, m_emitter.lifetime);
+    m_emit->set_float("u_lifetime_jitter"_id, m_emitter.lifetime_jitter);
+    m_emit->set_int("u_seed"_id, (i32) ++m_seed);
+    glDispatchComputeIndirect(emit_dispatch_offset);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_simulate->bind();
+    m_simulate->set_int("u_current"_id, (i32) m_current);
+    m_simulate->set_float("u_dt"_id, dt);
+    m_simulate->set_vec3("u_gravity"_id, m_gravity);
+    glDispatchComputeIndirect(simulate_dispatch_offset);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_finalize->bind();
+    m_finalize->set_int("u_current"_id, (i32) m_current);
+    glDispatchCompute(1, 1, 1);
+    // Buffer update orders the counter writes before the stats copy below
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+
+    if (measure)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        glBindBuffer(GL_COPY_READ_BUFFER, m_counters);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, slot.counters);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, counter_count * sizeof(u32));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        slot.fence   = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.current = m_current;
+        slot.pending = true;
+    }
+
+    // Survivors were written to the other list, it's the current one from now on. render() draws from alive_next,
+    // which is bound to that list until the next update
+    ++m_frame;
+    m_current = 1 - m_current;
+}
+
+void particle_system::collect_stats()
+{
+    for (auto& slot : m_stats_ring)
+    {
+        if (!slot.pending || glClientWaitSync((GLsync) slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            continue;
+        }
+
+        GLuint64 elapsed_ns = 0;
+        glGetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &elapsed_ns);
+
+        u32 counters[counter_count]{};
+        glBindBuffer(GL_COPY_READ_BUFFER, slot.counters);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(counters), counters);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+        const u32 simulated      = counters[1 + slot.current];
+        m_stats.alive            = counters[2 - slot.current];
+        m_stats.simulate_ms      = (f64) elapsed_ns / 1e6;
+        m_stats.particles_per_ms = m_stats.simulate_ms > 0.0 ? simulated / m_stats.simulate_ms : 0.0;
+
+        glDeleteSync((GLsync) slot.fence);
+        slot.fence   = nullptr;
+        slot.pending = false;
+    }
+}
+
+void particle_system::render(f32 size)
+{
+    if (!m_capacity)
+    {
+        return;
+    }
+
+    // After update() m_current is the list the survivors went to, bind it where the vertex shader reads from
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, particles_binding, m_particles);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, alive_next_binding, m_alive[m_current]);
+
+    m_render->bind();
+    m_render->set_float("u_size"_id, size);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    glDepthMask(GL_FALSE);
+
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect);
+    glDrawArraysIndirect(GL_TRIANGLE_STRIP, (const void*) draw_offset);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+} // namespace blaze::gfx
@@ -16,12 +16,14 @@
 //     limitations under the License.
 //
 //  ------------------------------------------------------------------------------
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <utility>
 #include <GL/glew.h>
 
 #include "Graphics/Shader.h"
+#include "Graphics/DeletionQueue.h"
+#include "Graphics/UniformBlocks.h"
+#include "Core/FileWatcher.h"
 #include "Core/Logger.h"
 
 namespace blaze::gfx
@@ -29,30 +31,18 @@ namespace blaze::gfx
 
 namespace
 {
-std::string shaders_path = "./assets/shaders/";
+std::string  shaders_path = "./assets/shaders/";
+file_watcher watcher{};
+bool         parallel_compile = false;
 
-
-std::string read_file(const std::string& file)
+// Function local so shaders with static storage can register before this file's statics are initialized
+std::vector<shader*>& live_shaders()
 {
-    std::string   source{};
-    std::ifstream stream;
-    stream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
-    {
-        stream.open(file);
-        std::stringstream buffer;
-        buffer << stream.rdbuf();
-        stream.close();
-        source = buffer.str();
-    } catch (std::ifstream::failure& e)
-    {
-        LOG_ERROR("Failed to read shader file [{}]: {}", file, e.what());
-        return {};
-    }
-    return source;
+    static std::vector<shader*> shaders;
+    return shaders;
 }
 
-bool check_error(u32 id, const std::string& type)
+bool check_error(u32 id, const std::string& type, const std::vector<std::string>& files)
 {
     i32  success;
     char info_log[1024];
@@ -62,7 +52,7 @@ bool check_error(u32 id, const std::string& type)
         if (!success)
         {
             glGetShaderInfoLog(id, 1024, nullptr, info_log);
-            LOG_ERROR("Shader compilation error: {}", info_log);
+            LOG_ERROR("Shader compilation error: {}", preprocessor::remap_log(info_log, files));
             return true;
         }
     } else
@@ -71,7 +61,7 @@ bool check_error(u32 id, const std::string& type)
         if (!success)
         {
             glGetProgramInfoLog(id, 1024, nullptr, info_log);
-            LOG_ERROR("Shader linking error: {}", info_log);
+            LOG_ERROR("Shader linking error: {}", preprocessor::remap_log(info_log, files));
             return true;
         }
     }
@@ -81,78 +71,203 @@ bool check_error(u32 id, const std::string& type)
 
 } // anonymous namespace
 
-shader::shader(std::string shader_name) : m_name(std::move(shader_name)) {}
+shader::shader(std::string shader_name, define_set defines) :
+    m_name(std::move(shader_name)), m_defines(std::move(defines))
+{
+    live_shaders().emplace_back(this);
+}
 
 bool shader::load()
 {
-    m_vertex_file               = shaders_path + m_name + ".vs";
-    m_fragment_file             = shaders_path + m_name + ".fs";
-    std::string vertex_source   = read_file(m_vertex_file);
-    std::string fragment_source = read_file(m_fragment_file);
-    if (vertex_source.empty() || fragment_source.empty())
+    m_compute       = false;
+    m_vertex_file   = m_name + ".vs";
+    m_fragment_file = m_name + ".fs";
+    m_dependencies  = { m_vertex_file, m_fragment_file }; // until a build succeeds, so a broken shader can be fixed live
+
+    build b{};
+    return start_build(b) && finish_build(b);
+}
+
+bool shader::load_compute()
+{
+    m_compute      = true;
+    m_compute_file = m_name + ".cs";
+    m_dependencies = { m_compute_file };
+
+    build b{};
+    return start_build(b) && finish_build(b);
+}
+
+void shader::reload()
+{
+    if (m_pending.program)
     {
-        return false;
+        // Sources changed again mid compile, start over from the newest
+        discard_build(m_pending);
+    }
+    if (!start_build(m_pending))
+    {
+        LOG_ERROR("Reloading shader {} failed, keeping the previous program", m_name);
+        return;
+    }
+    if (!parallel_compile)
+    {
+        m_pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
     }
+}
 
-    if (!compile(vertex_source, fragment_source))
+bool shader::poll_reload()
+{
+    if (!m_pending.program)
     {
         return false;
     }
+    if (parallel_compile)
+    {
+        GLint done = GL_FALSE;
+        glGetProgramiv(m_pending.program, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done)
+        {
+            return false;
+        }
+    } else if (m_pending.fence)
+    {
+        // Querying the status before the driver is done would block the frame, wait until the link is behind us
+        const GLenum status = glClientWaitSync((GLsync) m_pending.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            return false;
+        }
+        glDeleteSync((GLsync) m_pending.fence);
+        m_pending.fence = nullptr;
+    }
 
+    if (!finish_build(m_pending))
+    {
+        LOG_ERROR("Reloading shader {} failed, keeping the previous program", m_name);
+        return false;
+    }
+    LOG_INFO("Reloaded shader {}", m_name);
     return true;
 }
 
-bool shader::compile(const std::string& vertex_shader, const std::string& fragment_shader)
+bool shader::depends_on(const std::string& file) const
 {
-    const char* vsrc = vertex_shader.c_str();
-    const char* fsrc = fragment_shader.c_str();
+    return std::find(m_dependencies.begin(), m_dependencies.end(), file) != m_dependencies.end();
+}
 
-    // Compile vertex shader
-    u32 vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vsrc, nullptr);
-    glCompileShader(vertex);
-    if (check_error(vertex, "VERTEX"))
+bool shader::start_build(build& b) const
+{
+    preprocessed_source sources[2];
+    GLenum              types[2];
+    if (m_compute)
     {
-        glDeleteShader(vertex);
-        return false;
+        b.stage_count = 1;
+        types[0]      = GL_COMPUTE_SHADER;
+        if (!preprocessor::process(shaders_path, m_compute_file, m_defines, sources[0]))
+        {
+            return false;
+        }
+    } else
+    {
+        b.stage_count = 2;
+        types[0]      = GL_VERTEX_SHADER;
+        types[1]      = GL_FRAGMENT_SHADER;
+        if (!preprocessor::process(shaders_path, m_vertex_file, m_defines, sources[0]) ||
+            !preprocessor::process(shaders_path, m_fragment_file, m_defines, sources[1]))
+        {
+            return false;
+        }
     }
 
-    // Compile fragment shader
-    u32 fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fsrc, nullptr);
-    glCompileShader(fragment);
-    if (check_error(fragment, "FRAGMENT"))
+    // Nothing here waits on the driver, with parallel compile it all happens on the driver's threads
+    b.program = glCreateProgram();
+    for (u32 i = 0; i < b.stage_count; ++i)
     {
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        return false;
+        const char* source = sources[i].text.c_str();
+        b.stages[i]        = glCreateShader(types[i]);
+        b.files[i]         = std::move(sources[i].files);
+        glShaderSource(b.stages[i], 1, &source, nullptr);
+        glCompileShader(b.stages[i]);
+        glAttachShader(b.program, b.stages[i]);
+    }
+    glLinkProgram(b.program);
+    return true;
+}
+
+bool shader::finish_build(build& b)
+{
+    constexpr const char* stage_names[2][2] = { { "VERTEX", "FRAGMENT" }, { "COMPUTE", "" } };
+
+    bool failed = false;
+    for (u32 i = 0; i < b.stage_count && !failed; ++i)
+    {
+        failed = check_error(b.stages[i], stage_names[m_compute][i], b.files[i]);
+    }
+    if (!failed)
+    {
+        failed = check_error(b.program, "PROGRAM", b.files[0]);
+    }
+    if (!failed)
+    {
+        failed = !uniforms::validate_program(b.program, m_name);
     }
 
-    // Link shaders
-    m_id = glCreateProgram();
-    glAttachShader(m_id, vertex);
-    glAttachShader(m_id, fragment);
-    glLinkProgram(m_id);
-    if (check_error(m_id, "PROGRAM"))
+    // A failed build still watches everything it read, the fix may be in an include. A good one replaces the list
+    if (!failed)
+    {
+        m_dependencies.clear();
+    }
+    for (u32 i = 0; i < b.stage_count; ++i)
     {
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        for (auto& file : b.files[i])
+        {
+            if (!depends_on(file))
+            {
+                m_dependencies.emplace_back(std::move(file));
+            }
+        }
+    }
+    if (failed)
+    {
+        discard_build(b);
         return false;
     }
 
-    // Clean up
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    for (u32 i = 0; i < b.stage_count; ++i)
+    {
+        glDeleteShader(b.stages[i]);
+    }
 
+    // The old program may still be referenced by queued draws
+    deletion::retire(gl_object::program, m_id);
+    m_id = b.program;
+    b    = {};
+    cache_locations();
     return true;
 }
 
-shader::~shader()
+void shader::discard_build(build& b)
 {
-    if (m_id != u32_invalid_id)
+    if (b.fence)
+    {
+        glDeleteSync((GLsync) b.fence);
+    }
+    for (u32 i = 0; i < b.stage_count; ++i)
     {
-        glDeleteProgram(m_id);
+        glDeleteShader(b.stages[i]);
     }
+    deletion::retire(gl_object::program, b.program);
+    b = {};
+}
+
+shader::~shader()
+{
+    auto& shaders = live_shaders();
+    shaders.erase(std::remove(shaders.begin(), shaders.end(), this), shaders.end());
+
+    discard_build(m_pending);
+    deletion::retire(gl_object::program, m_id);
 }
 
 void shader::bind() const
@@ -162,23 +277,106 @@ void shader::bind() const
 
 void shader::destroy()
 {
-    glDeleteProgram(m_id);
+    discard_build(m_pending);
+    deletion::retire(gl_object::program, m_id);
     m_id = u32_invalid_id;
+    m_locations.clear();
+}
+
+void shader::cache_locations()
+{
+    m_locations.clear();
+
+    GLint count = 0;
+    glGetProgramInterfaceiv(m_id, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        const GLenum location_property = GL_LOCATION;
+        GLint        location          = -1;
+        glGetProgramResourceiv(m_id, GL_UNIFORM, (GLuint) i, 1, &location_property, 1, nullptr, &location);
+        if (location < 0)
+        {
+            continue; // uniform block member
+        }
+
+        char    name[256];
+        GLsizei length = 0;
+        glGetProgramResourceName(m_id, GL_UNIFORM, (GLuint) i, (GLsizei) sizeof(name), &length, name);
+        const std::string_view uniform{ name, (size_t) length };
+        m_locations.emplace(intern(uniform), location);
+
+        // Arrays are reported as name[0], the bare name should find them too
+        if (uniform.ends_with("[0]"))
+        {
+            m_locations.emplace(intern(uniform.substr(0, uniform.size() - 3)), location);
+        }
+    }
+}
+
+i32 shader::location(hashed_id name) const
+{
+    const auto it = m_locations.find(name);
+    return it != m_locations.end() ? it->second : -1;
+}
+
+void shader::set_bool(hashed_id name, bool value) const
+{
+    glUniform1i(location(name), (i32) value);
+}
+
+void shader::set_int(hashed_id name, i32 value) const
+{
+    glUniform1i(location(name), value);
+}
+
+void shader::set_float(hashed_id name, f32 value) const
+{
+    glUniform1f(location(name), value);
+}
+
+void shader::set_vec3(hashed_id name, const f32* value) const
+{
+    glUniform3fv(location(name), 1, value);
+}
+
+void shader::set_vec4(hashed_id name, const f32* value) const
+{
+    glUniform4fv(location(name), 1, value);
+}
+
+void shader::set_mat4(hashed_id name, const f32* value) const
+{
+    glUniformMatrix4fv(location(name), 1, GL_FALSE, value);
 }
 
 void shader::set_bool(const std::string& name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(m_id, name.c_str()), (i32) value);
+    set_bool(hashed_id{ name }, value);
 }
 
 void shader::set_int(const std::string& name, i32 value) const
 {
-    glUniform1i(glGetUniformLocation(m_id, name.c_str()), value);
+    set_int(hashed_id{ name }, value);
 }
 
 void shader::set_float(const std::string& name, f32 value) const
 {
-    glUniform1f(glGetUniformLocation(m_id, name.c_str()), value);
+    set_float(hashed_id{ name }, value);
+}
+
+void shader::set_vec3(const std::string& name, const f32* value) const
+{
+    set_vec3(hashed_id{ name }, value);
+}
+
+void shader::set_vec4(const std::string& name, const f32* value) const
+{
+    set_vec4(hashed_id{ name }, value);
+}
+
+void shader::set_mat4(const std::string& name, const f32* value) const
+{
+    set_mat4(hashed_id{ name }, value);
 }
 
 
@@ -187,4 +385,65 @@ void set_shaders_path(const std::string& path)
     shaders_path = path;
 }
 
+bool enable_hot_reload()
+{
+    if (watcher.watching())
+    {
+        return true;
+    }
+    if (!watcher.start(shaders_path))
+    {
+        return false;
+    }
+
+    // 0xFFFFFFFF lets the driver pick the thread count
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        parallel_compile = true;
+    } else if (GLEW_ARB_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        parallel_compile = true;
+    } else
+    {
+        LOG_WARN("No parallel shader compile, reloads wait on a fence behind the link before checking the result");
+    }
+
+    LOG_INFO("Shader hot reload watching {}", shaders_path);
+    return true;
+}
+
+void disable_hot_reload()
+{
+    watcher.stop();
+}
+
+void update_hot_reload()
+{
+    if (!watcher.watching())
+    {
+        return;
+    }
+
+    static std::vector<std::string> changed;
+    if (watcher.changes(changed))
+    {
+        for (shader* s : live_shaders())
+        {
+            auto depends = [s](const std::string& file) { return s->depends_on(file); };
+            if (std::any_of(changed.begin(), changed.end(), depends))
+            {
+                s->reload();
+            }
+        }
+        changed.clear();
+    }
+
+    for (shader* s : live_shaders())
+    {
+        s->poll_reload();
+    }
+}
+
 } // namespace blaze::gfx
\ No newline at end of file
@@ -0,0 +1,73 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#include "Graphics/ShaderLibrary.h"
+
+#include "Core/Logger.h"
+
+namespace blaze::gfx
+{
+
+shader* shader_library::get(const std::string& program, const define_set& defines)
+{
+    return get(program, defines, false);
+}
+
+shader* shader_library::get_compute(const std::string& program, const define_set& defines)
+{
+    return get(program, defines, true);
+}
+
+shader* shader_library::find(u64 key) const
+{
+    const auto it = m_variants.find(key);
+    return it != m_variants.end() ? it->second.get() : nullptr;
+}
+
+shader_library& shaders()
+{
+    static shader_library library;
+    return library;
+}
+
+void shader_library::clear()
+{
+    m_variants.clear();
+}
+
+shader* shader_library::get(const std::string& program, const define_set& defines, bool compute)
+{
+    const u64 key = preprocessor::variant_key(program, defines, compute);
+    if (const auto it = m_variants.find(key); it != m_variants.end())
+    {
+        return it->second.get();
+    }
+
+    auto variant = memory::make_pool_uptr(m_pool, program, defines);
+    ++m_compiled;
+    if (!(compute ? variant->load_compute() : variant->load()))
+    {
+        LOG_ERROR("Variant {:#018x} of {} failed to compile", key, program);
+        variant.reset();
+    }
+
+    return m_variants.emplace(key, std::move(variant)).first->second.get();
+}
+
+} // namespace blaze::gfx
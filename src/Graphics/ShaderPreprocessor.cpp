@@ -0,0 +1,217 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#include "Graphics/ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <regex>
+#include <string_view>
+
+#include "Core/HashedId.h"
+#include "Core/Logger.h"
+
+namespace blaze::gfx::preprocessor
+{
+
+namespace
+{
+struct context
+{
+    const std::string&        root;
+    std::string&              text;
+    std::vector<std::string>& files;
+};
+
+std::string_view trim(std::string_view line)
+{
+    const auto first = line.find_first_not_of(" \t");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    const auto last = line.find_last_not_of(" \t\r");
+    return line.substr(first, last - first + 1);
+}
+
+bool starts_with_directive(std::string_view line, std::string_view directive)
+{
+    if (!line.starts_with('#'))
+    {
+        return false;
+    }
+    line = trim(line.substr(1)); // '# include' is legal
+    return line.starts_with(directive) && (line.size() == directive.size() || line[directive.size()] == ' ' ||
+                                           line[directive.size()] == '\t' || line[directive.size()] == '"' ||
+                                           line[directive.size()] == '<');
+}
+
+// Defines are only given for the top level file, includes get nullptr
+bool emit(context& ctx, const std::string& file, const define_set* defines)
+{
+    std::ifstream stream(ctx.root + file);
+    if (!stream)
+    {
+        LOG_ERROR("Failed to read shader file [{}]", ctx.root + file);
+        return false;
+    }
+
+    const auto index = (u32) ctx.files.size();
+    ctx.files.emplace_back(file);
+    if (!defines)
+    {
+        ctx.text += std::format("#line 1 {}\n", index);
+    }
+
+    std::string line;
+    u32         number = 0;
+    bool        version_seen = false;
+    while (std::getline(stream, line))
+    {
+        ++number;
+        const std::string_view directive = trim(line);
+
+        if (starts_with_directive(directive, "version"))
+        {
+            if (!defines)
+            {
+                LOG_WARN("{}:{}: #version in an included file is ignored", file, number);
+                ctx.text += '\n';
+                continue;
+            }
+            version_seen = true;
+            ctx.text += line;
+            ctx.text += '\n';
+            for (const auto& define : *defines)
+            {
+                ctx.text += std::format("#define {} {}\n", define.name, define.value);
+            }
+            ctx.text += std::format("#line {} {}\n", number + 1, index);
+            continue;
+        }
+
+        if (starts_with_directive(directive, "pragma once"))
+        {
+            ctx.text += '\n';
+            continue;
+        }
+
+        if (starts_with_directive(directive, "include"))
+        {
+            const auto open  = directive.find_first_of("\"<");
+            const auto close = open == std::string_view::npos ? open : directive.find_first_of("\">", open + 1);
+            if (close == std::string_view::npos)
+            {
+                LOG_ERROR("{}:{}: malformed #include", file, number);
+                return false;
+            }
+
+            const std::string name{ directive.substr(open + 1, close - open - 1) };
+            if (std::find(ctx.files.begin(), ctx.files.end(), name) == ctx.files.end())
+            {
+                if (!emit(ctx, name, nullptr))
+                {
+                    LOG_ERROR("{}:{}: included from here", file, number);
+                    return false;
+                }
+            }
+            ctx.text += std::format("#line {} {}\n", number + 1, index);
+            continue;
+        }
+
+        ctx.text += line;
+        ctx.text += '\n';
+    }
+
+    if (defines && !version_seen)
+    {
+        LOG_ERROR("{} has no #version directive", file);
+        return false;
+    }
+    return true;
+}
+} // anonymous namespace
+
+bool process(const std::string& root, const std::string& file, const define_set& defines, preprocessed_source& out)
+{
+    out.text.clear();
+    out.files.clear();
+
+    context ctx{ root, out.text, out.files };
+    return emit(ctx, file, &defines);
+}
+
+std::string remap_log(const std::string& log, const std::vector<std::string>& files)
+{
+    // Mesa and AMD print "0:12(5):" or "ERROR: 0:12:", NVIDIA prints "0(12) :". The first number is the source string
+    static const std::regex location{ R"(^(\s*(?:ERROR:|WARNING:)?\s*)(\d+)([:(]\d+))" };
+
+    std::string result;
+    result.reserve(log.size());
+    size_t start = 0;
+    while (start < log.size())
+    {
+        auto end = log.find('\n', start);
+        end      = end == std::string::npos ? log.size() : end + 1;
+        const std::string line{ log.substr(start, end - start) };
+        start = end;
+
+        std::smatch match;
+        if (std::regex_search(line, match, location))
+        {
+            const auto index = std::stoul(match[2].str());
+            if (index < files.size())
+            {
+                result += match[1].str() + files[index] + match[3].str() + match.suffix().str();
+                continue;
+            }
+        }
+        result += line;
+    }
+    return result;
+}
+
+u64 variant_key(const std::string& program, const define_set& defines, bool compute)
+{
+    std::vector<const shader_define*> sorted;
+    sorted.reserve(defines.size());
+    for (const auto& define : defines)
+    {
+        sorted.emplace_back(&define);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const shader_define* a, const shader_define* b) {
+        return a->name != b->name ? a->name < b->name : a->value < b->value;
+    });
+
+    // FNV-1a, with separators so ("AB", "C") and ("A", "BC") differ
+    u64  key = hash::fnv_offset;
+    auto mix = [&key](std::string_view bytes, char separator) {
+        key = hash::fnv1a({ &separator, 1 }, hash::fnv1a(bytes, key));
+    };
+    mix(program, compute ? '\1' : '\0');
+    for (const auto* define : sorted)
+    {
+        mix(define->name, '=');
+        mix(define->value, '\0');
+    }
+    return key;
+}
+
+} // namespace blaze::gfx::preprocessor
@@ -0,0 +1,494 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#include "Graphics/TextRenderer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <GL/glew.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "Graphics/DeletionQueue.h"
+#include "Core/HashedId.h"
+#include "Core/Logger.h"
+
+namespace blaze::gfx
+{
+
+namespace
+{
+constexpr u32 glyph_padding     = 1;   // texels between glyphs so linear filtering doesn't bleed
+constexpr u64 run_lifetime      = 300; // frames a cached run survives without being drawn
+constexpr u64 run_evict_period  = 60;
+constexpr u32 instance_location = 0;
+
+u64 hash_text(u32 font, std::string_view text)
+{
+    // FNV-1a over the font index and the bytes
+    const char index[4] = { (char) font, (char) (font >> 8), (char) (font >> 16), (char) (font >> 24) };
+    return hash::fnv1a(text, hash::fnv1a({ index, 4 }));
+}
+
+// Decodes one code point and advances pos. Malformed sequences come out as U+FFFD
+u32 next_codepoint(std::string_view text, size_t& pos)
+{
+    const u8 lead = (u8) text[pos++];
+    if (lead < 0x80)
+    {
+        return lead;
+    }
+
+    u32 extra;
+    u32 codepoint;
+    if ((lead & 0xE0) == 0xC0)
+    {
+        extra     = 1;
+        codepoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0)
+    {
+        extra     = 2;
+        codepoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0)
+    {
+        extra     = 3;
+        codepoint = lead & 0x07;
+    } else
+    {
+        return 0xFFFD;
+    }
+
+    for (u32 i = 0; i < extra; ++i)
+    {
+        if (pos >= text.size() || ((u8) text[pos] & 0xC0) != 0x80)
+        {
+            return 0xFFFD;
+        }
+        codepoint = (codepoint << 6) | ((u8) text[pos++] & 0x3F);
+    }
+    return codepoint;
+}
+
+u32 pack_color(const f32* color)
+{
+    u32 packed = 0;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        const f32 c = std::clamp(color[i], 0.0f, 1.0f);
+        packed |= (u32) (c * 255.0f + 0.5f) << (i * 8);
+    }
+    return packed;
+}
+} // anonymous namespace
+
+text_renderer::~text_renderer()
+{
+    destroy();
+}
+
+bool text_renderer::create(u32 atlas_size, u32 max_glyphs)
+{
+    destroy();
+
+    FT_Library library;
+    if (FT_Init_FreeType(&library))
+    {
+        LOG_ERROR("Failed to initialize FreeType");
+        return false;
+    }
+    m_library = library;
+
+    m_shader = make_uptr<shader>("text_sdf");
+    if (!m_shader->load())
+    {
+        destroy();
+        return false;
+    }
+
+    m_atlas_size = atlas_size;
+    m_max_glyphs = max_glyphs;
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_instances);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instances);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (max_glyphs * sizeof(glyph_instance)), nullptr, GL_STREAM_DRAW);
+
+    constexpr GLsizei stride = sizeof(glyph_instance);
+    glEnableVertexAttribArray(instance_location);
+    glVertexAttribPointer(instance_location, 4, GL_FLOAT, GL_FALSE, stride,
+                          (const void*) offsetof(glyph_instance, rect));
+    glVertexAttribDivisor(instance_location, 1);
+    glEnableVertexAttribArray(instance_location + 1);
+    glVertexAttribPointer(instance_location + 1, 4, GL_FLOAT, GL_FALSE, stride,
+                          (const void*) offsetof(glyph_instance, uv));
+    glVertexAttribDivisor(instance_location + 1, 1);
+    glEnableVertexAttribArray(instance_location + 2);
+    glVertexAttribPointer(instance_location + 2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                          (const void*) offsetof(glyph_instance, color));
+    glVertexAttribDivisor(instance_location + 2, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void text_renderer::destroy()
+{
+    for (auto& f : m_fonts)
+    {
+        FT_Done_Face((FT_Face) f.face);
+    }
+    m_fonts.clear();
+    if (m_library)
+    {
+        FT_Done_FreeType((FT_Library) m_library);
+        m_library = nullptr;
+    }
+
+    for (auto& p : m_pages)
+    {
+        deletion::retire(gl_object::texture, p.texture, (u64) m_atlas_size * m_atlas_size);
+    }
+    m_pages.clear();
+    m_batches.clear();
+    m_runs.clear();
+
+    deletion::retire(gl_object::buffer, m_instances, (u64) m_max_glyphs * sizeof(glyph_instance));
+    deletion::retire(gl_object::vertex_array, m_vao);
+    m_instances = 0;
+    m_vao       = 0;
+    m_shader.reset();
+    m_stats = {};
+}
+
+font_handle text_renderer::load_font(const std::string& file, u32 pixel_size)
+{
+    if (!m_library)
+    {
+        return {};
+    }
+
+    FT_Face face;
+    if (FT_New_Face((FT_Library) m_library, file.c_str(), 0, &face))
+    {
+        LOG_ERROR("Failed to load font {}", file);
+        return {};
+    }
+    if (FT_Set_Pixel_Sizes(face, 0, pixel_size))
+    {
+        LOG_ERROR("Font {} has no size {}", file, pixel_size);
+        FT_Done_Face(face);
+        return {};
+    }
+
+    font f{};
+    f.face        = face;
+    f.ascender    = (f32) face->size->metrics.ascender / 64.0f;
+    f.line_height = (f32) face->size->metrics.height / 64.0f;
+    m_fonts.emplace_back(std::move(f));
+
+    LOG_INFO("Loaded font {} at {}px", file, pixel_size);
+    return { (u32) m_fonts.size() - 1 };
+}
+
+const text_renderer::glyph* text_renderer::find_glyph(font& f, u32 codepoint)
+{
+    if (auto it = f.glyphs.find(codepoint); it != f.glyphs.end())
+    {
+        return &it->second;
+    }
+
+    auto       face  = (FT_Face) f.face;
+    const auto index = FT_Get_Char_Index(face, codepoint);
+    if (FT_Load_Glyph(face, index, FT_LOAD_DEFAULT))
+    {
+        return nullptr;
+    }
+
+    glyph g{};
+    g.index   = index;
+    g.advance = (f32) face->glyph->advance.x / 64.0f;
+
+    // Outline glyphs with no area (spaces) have nothing to render and the SDF renderer rejects them
+    if (face->glyph->format == FT_GLYPH_FORMAT_OUTLINE && face->glyph->outline.n_points > 0 &&
+        !FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF))
+    {
+        // The bitmap includes the distance field's spread on every side, bitmap_left/top account for it
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        u32              page_index;
+        u32              x;
+        u32              y;
+        if (bitmap.width && bitmap.rows && pack(bitmap.width, bitmap.rows, page_index, x, y))
+        {
+            glBindTexture(GL_TEXTURE_2D, m_pages[page_index].texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, bitmap.pitch);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, (GLint) x, (GLint) y, (GLsizei) bitmap.width, (GLsizei) bitmap.rows,
+                            GL_RED, GL_UNSIGNED_BYTE, bitmap.buffer);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            const f32 texel = 1.0f / (f32) m_atlas_size;
+            g.offset_x      = (f32) face->glyph->bitmap_left;
+            g.offset_y      = -(f32) face->glyph->bitmap_top;
+            g.width         = (f32) bitmap.width;
+            g.height        = (f32) bitmap.rows;
+            g.uv[0]         = (f32) x * texel;
+            g.uv[1]         = (f32) y * texel;
+            g.uv[2]         = (f32) (x + bitmap.width) * texel;
+            g.uv[3]         = (f32) (y + bitmap.rows) * texel;
+            g.page          = page_index;
+        }
+    }
+
+    return &f.glyphs.emplace(codepoint, g).first->second;
+}
+
+bool text_renderer::pack(u32 width, u32 height, u32& page_index, u32& x, u32& y)
+{
+    const u32 padded_width  = width + glyph_padding;
+    const u32 padded_height = height + glyph_padding;
+    if (padded_width > m_atlas_size || padded_height > m_atlas_size)
+    {
+        LOG_WARN("Glyph of {}x{} doesn't fit a {} atlas", width, height, m_atlas_size);
+        return false;
+    }
+
+    // Shelf packing into the newest page, full pages are never revisited
+    if (!m_pages.empty())
+    {
+        page& p = m_pages.back();
+        if (p.cursor_x + padded_width > m_atlas_size)
+        {
+            p.cursor_x = 0;
+            p.cursor_y += p.shelf_height;
+            p.shelf_height = 0;
+        }
+        if (p.cursor_y + padded_height <= m_atlas_size)
+        {
+            page_index = (u32) m_pages.size() - 1;
+            x          = p.cursor_x;
+            y          = p.cursor_y;
+            p.cursor_x += padded_width;
+            p.shelf_height = std::max(p.shelf_height, padded_height);
+            return true;
+        }
+    }
+
+    page p{};
+    glGenTextures(1, &p.texture);
+    glBindTexture(GL_TEXTURE_2D, p.texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, (GLsizei) m_atlas_size, (GLsizei) m_atlas_size);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    const u8 zero = 0;
+    glClearTexImage(p.texture, 0, GL_RED, GL_UNSIGNED_BYTE, &zero);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    p.cursor_x     = padded_width;
+    p.shelf_height = padded_height;
+    m_pages.emplace_back(p);
+    m_batches.resize(m_pages.size());
+
+    page_index = (u32) m_pages.size() - 1;
+    x          = 0;
+    y          = 0;
+    return true;
+}
+
+const text_renderer::run& text_renderer::layout(font_handle handle, std::string_view text)
+{
+    const u64 key = hash_text(handle.index, text);
+    auto [first, last] = m_runs.equal_range(key);
+    for (auto it = first; it != last; ++it)
+    {
+        if (it->second.text == text)
+        {
+            it->second.last_used = m_frame;
+            return it->second;
+        }
+    }
+
+    ++m_run_misses;
+    font& f    = m_fonts[handle.index];
+    auto  face = (FT_Face) f.face;
+
+    run r{};
+    r.text      = text;
+    r.last_used = m_frame;
+
+    // Advances plus pair kerning, no complex shaping
+    f32  pen_x    = 0.0f;
+    f32  baseline = f.ascender;
+    u32  previous = 0;
+    bool kerning  = FT_HAS_KERNING(face);
+    for (size_t pos = 0; pos < text.size();)
+    {
+        const u32 codepoint = next_codepoint(text, pos);
+        if (codepoint == '\n')
+        {
+            r.width = std::max(r.width, pen_x);
+            pen_x   = 0.0f;
+            baseline += f.line_height;
+            previous = 0;
+            continue;
+        }
+
+        const glyph* g = find_glyph(f, codepoint);
+        if (!g)
+        {
+            continue;
+        }
+        if (kerning && previous && g->index)
+        {
+            FT_Vector delta;
+            if (!FT_Get_Kerning(face, previous, g->index, FT_KERNING_DEFAULT, &delta))
+            {
+                pen_x += (f32) delta.x / 64.0f;
+            }
+        }
+
+        if (g->page != u32_invalid_id)
+        {
+            run_glyph rg{};
+            rg.rect[0] = pen_x + g->offset_x;
+            rg.rect[1] = baseline + g->offset_y;
+            rg.rect[2] = g->width;
+            rg.rect[3] = g->height;
+            std::copy_n(g->uv, 4, rg.uv);
+            rg.page = g->page;
+            r.glyphs.emplace_back(rg);
+        }
+        pen_x += g->advance;
+        previous = g->index;
+    }
+    r.width  = std::max(r.width, pen_x);
+    r.height = baseline - f.ascender + f.line_height;
+
+    return m_runs.emplace(key, std::move(r))->second;
+}
+
+void text_renderer::draw(font_handle handle, std::string_view text, f32 x, f32 y, f32 scale, const f32* color)
+{
+    if (!handle.is_valid() || handle.index >= m_fonts.size() || text.empty())
+    {
+        return;
+    }
+
+    const run& r      = layout(handle, text);
+    const u32  packed = pack_color(color);
+    for (const auto& rg : r.glyphs)
+    {
+        glyph_instance instance{};
+        instance.rect[0] = x + rg.rect[0] * scale;
+        instance.rect[1] = y + rg.rect[1] * scale;
+        instance.rect[2] = rg.rect[2] * scale;
+        instance.rect[3] = rg.rect[3] * scale;
+        std::copy_n(rg.uv, 4, instance.uv);
+        instance.color = packed;
+        m_batches[rg.page].emplace_back(instance);
+    }
+}
+
+void text_renderer::measure(font_handle handle, std::string_view text, f32& width, f32& height)
+{
+    width  = 0.0f;
+    height = 0.0f;
+    if (!handle.is_valid() || handle.index >= m_fonts.size() || text.empty())
+    {
+        return;
+    }
+
+    const run& r = layout(handle, text);
+    width        = r.width;
+    height       = r.height;
+}
+
+void text_renderer::flush(i32 screen_width, i32 screen_height)
+{
+    m_stats.glyphs  = 0;
+    m_stats.batches = 0;
+
+    if (m_vao)
+    {
+        // Pages are packed back to back into the instance buffer and drawn with a base instance each
+        glBindBuffer(GL_ARRAY_BUFFER, m_instances);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (m_max_glyphs * sizeof(glyph_instance)), nullptr, GL_STREAM_DRAW);
+
+        // Pixels to clip space, y down
+        const f32 screen[4] = { 2.0f / (f32) screen_width, -2.0f / (f32) screen_height, -1.0f, 1.0f };
+        m_shader->bind();
+        m_shader->set_vec4("u_screen"_id, screen);
+        m_shader->set_int("u_atlas"_id, 0);
+
+        const GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBindVertexArray(m_vao);
+        glActiveTexture(GL_TEXTURE0);
+
+        u32 offset = 0;
+        for (u32 i = 0; i < m_batches.size(); ++i)
+        {
+            auto&     batch = m_batches[i];
+            const u32 count = std::min((u32) batch.size(), m_max_glyphs - offset);
+            if (count == 0)
+            {
+                batch.clear();
+                continue;
+            }
+
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) (offset * sizeof(glyph_instance)),
+                            (GLsizeiptr) (count * sizeof(glyph_instance)), batch.data());
+            glBindTexture(GL_TEXTURE_2D, m_pages[i].texture);
+            glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) count, offset);
+
+            offset += count;
+            ++m_stats.batches;
+            batch.clear();
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glDisable(GL_BLEND);
+        if (depth_test)
+        {
+            glEnable(GL_DEPTH_TEST);
+        }
+        m_stats.glyphs = offset;
+    }
+
+    if (++m_frame % run_evict_period == 0)
+    {
+        std::erase_if(m_runs, [this](const auto& entry) { return entry.second.last_used + run_lifetime < m_frame; });
+    }
+
+    m_stats.cached_runs = (u32) m_runs.size();
+    m_stats.pages       = (u32) m_pages.size();
+    m_stats.run_misses  = m_run_misses;
+    m_run_misses        = 0;
+}
+
+} // namespace blaze::gfx
@@ -0,0 +1,275 @@
+//  ------------------------------------------------------------------------------
+//
+//  blaze
+//     Copyright 2024 Matthew Rogers
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing, software
+//     distributed under the License is distributed on an "AS IS" BASIS,
+//     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//     See the License for the specific language governing permissions and
+//     limitations under the License.
+//
+//  ------------------------------------------------------------------------------
+
+#include "Graphics/UniformBlocks.h"
+
+#include <cstring>
+#include <span>
+#include <GL/glew.h>
+
+#include "Graphics/DeletionQueue.h"
+#include "Core/Logger.h"
+
+namespace blaze::gfx::uniforms
+{
+
+namespace
+{
+constexpr u32 frames_in_flight = 3;
+constexpr u64 fence_wait_ns    = 1'000'000;
+
+struct block_info
+{
+    const char*                   name;
+    uniform_slot                  slot;
+    u32                           size;
+    std::span<const block_member> members;
+};
+
+// Member names as declared in uniform_blocks.glsl
+constexpr block_member frame_members[] = {
+    { "u_time", offsetof(frame_block, time) },
+    { "u_delta_time", offsetof(frame_block, delta_time) },
+    { "u_frame_index", offsetof(frame_block, frame_index) },
+    { "u_resolution", offsetof(frame_block, resolution) },
+};
+constexpr block_member view_members[] = {
+    { "u_view", offsetof(view_block, view) },
+    { "u_projection", offsetof(view_block, projection) },
+    { "u_view_projection", offsetof(view_block, view_projection) },
+    { "u_camera_position", offsetof(view_block, camera_position) },
+    { "u_viewport", offsetof(view_block, viewport) },
+};
+constexpr block_member material_members[] = {
+    { "u_base_color", offsetof(material_block, base_color) },
+    { "u_roughness", offsetof(material_block, roughness) },
+    { "u_metallic", offsetof(material_block, metallic) },
+    { "u_emissive", offsetof(material_block, emissive) },
+    { "u_alpha_cutoff", offsetof(material_block, alpha_cutoff) },
+};
+constexpr block_member object_members[] = {
+    { "u_model", offsetof(object_block, model) },
+    { "u_normal_matrix", offsetof(object_block, normal_matrix) },
+};
+
+constexpr block_info blocks[] = {
+    { frame_block::block_name, frame_block::slot, sizeof(frame_block), frame_members },
+    { view_block::block_name, view_block::slot, sizeof(view_block), view_members },
+    { material_block::block_name, material_block::slot, sizeof(material_block), material_members },
+    { object_block::block_name, object_block::slot, sizeof(object_block), object_members },
+};
+
+u32    buffer{};
+u8*    mapped{ nullptr }; // null without ARB_buffer_storage, pushes go through glBufferSubData then
+u32    frame_size{};
+u32    alignment{ 256 };
+u32    frame{};
+u32    cursor{};
+GLsync fences[frames_in_flight]{};
+stats  current{};
+stats  previous{};
+} // anonymous namespace
+
+bool init(u32 frame_bytes)
+{
+    if (buffer)
+    {
+        return true;
+    }
+
+    GLint offset_alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offset_alignment);
+    alignment  = offset_alignment > 0 ? (u32) offset_alignment : 256;
+    frame_size = (frame_bytes + alignment - 1) / alignment * alignment;
+
+    const GLsizeiptr total = (GLsizeiptr) frame_size * frames_in_flight;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (GLEW_ARB_buffer_storage)
+    {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, total, nullptr, flags);
+        mapped = (u8*) glMapBufferRange(GL_UNIFORM_BUFFER, 0, total, flags);
+        if (!mapped)
+        {
+            LOG_ERROR("Failed to map the uniform ring");
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            shutdown();
+            return false;
+        }
+    } else
+    {
+        glBufferData(GL_UNIFORM_BUFFER, total, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    LOG_INFO("Uniform ring: {} x {}KB, {} byte alignment{}", frames_in_flight, frame_size / 1024, alignment,
+             mapped ? "" : ", not persistent");
+    return true;
+}
+
+void shutdown()
+{
+    for (auto& fence : fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (buffer)
+    {
+        if (mapped)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            mapped = nullptr;
+        }
+        deletion::retire(gl_object::buffer, buffer, (u64) frame_size * frames_in_flight);
+        buffer = 0;
+    }
+    current  = {};
+    previous = {};
+}
+
+const stats& last_stats()
+{
+    return previous;
+}
+
+bool validate_program(u32 program, const std::string& name)
+{
+    bool valid = true;
+    for (const auto& info : blocks)
+    {
+        const GLuint index = glGetProgramResourceIndex(program, GL_UNIFORM_BLOCK, info.name);
+        if (index == GL_INVALID_INDEX)
+        {
+            continue;
+        }
+
+        const GLenum size_property = GL_BUFFER_DATA_SIZE;
+        GLint        size          = 0;
+        glGetProgramResourceiv(program, GL_UNIFORM_BLOCK, index, 1, &size_property, 1, nullptr, &size);
+        if ((u32) size != info.size)
+        {
+            LOG_ERROR("{}: block {} is {} bytes, the C++ side is {}", name, info.name, size, info.size);
+            valid = false;
+        }
+
+        for (const auto& member : info.members)
+        {
+            const GLuint member_index = glGetProgramResourceIndex(program, GL_UNIFORM, member.name);
+            if (member_index == GL_INVALID_INDEX)
+            {
+                LOG_ERROR("{}: block {} has no member {}", name, info.name, member.name);
+                valid = false;
+                continue;
+            }
+
+            const GLenum offset_property = GL_OFFSET;
+            GLint        offset          = -1;
+            glGetProgramResourceiv(program, GL_UNIFORM, member_index, 1, &offset_property, 1, nullptr, &offset);
+            if ((u32) offset != member.offset)
+            {
+                LOG_ERROR("{}: {}.{} is at offset {}, the C++ side has {}", name, info.name, member.name, offset,
+                          member.offset);
+                valid = false;
+            }
+        }
+
+        glUniformBlockBinding(program, index, (GLuint) info.slot);
+    }
+    return valid;
+}
+
+namespace detail
+{
+void begin_frame()
+{
+    if (!buffer)
+    {
+        return;
+    }
+
+    frame = (frame + 1) % frames_in_flight;
+    if (GLsync& fence = fences[frame])
+    {
+        // Only blocks when the CPU is a full ring ahead of the GPU
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fence_wait_ns);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    cursor  = 0;
+    current = {};
+}
+
+void end_frame()
+{
+    if (!buffer)
+    {
+        return;
+    }
+
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    current.bytes = cursor;
+    previous      = current;
+}
+
+bool push(uniform_slot slot, const void* data, u32 size)
+{
+    if (!buffer)
+    {
+        return false;
+    }
+
+    const u32 start = (cursor + alignment - 1) / alignment * alignment;
+    if (start + size > frame_size)
+    {
+        if (current.overflows++ == 0)
+        {
+            LOG_WARN("Uniform ring frame range of {} bytes is full", frame_size);
+        }
+        return false;
+    }
+
+    const GLintptr offset = (GLintptr) frame * frame_size + start;
+    if (mapped)
+    {
+        std::memcpy(mapped + offset, data, size);
+    } else
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, (GLuint) slot, buffer, offset, size);
+
+    cursor = start + size;
+    ++current.uploads;
+    return true;
+}
+} // namespace detail
+
+} // namespace blaze::gfx::uniforms